@@ -1,21 +1,89 @@
 QT -= gui
-QT += network
 CONFIG += c++17 console
+
+# Optional QtNetwork UDP backend (LOG_UDP_TRANSPORT=qt): qmake CONFIG+=logix_qtnetwork
+logix_qtnetwork {
+    QT += network
+    DEFINES += LOGIX_WITH_QTNETWORK
+}
+# Coarse clock for records logged on the spdlog logger directly (LOG_CLOCK covers the LOGIX_* macros): qmake CONFIG+=logix_coarse_clock
+logix_coarse_clock {
+    DEFINES += SPDLOG_CLOCK_COARSE
+}
 CONFIG -= app_bundle
 
 # Prevent redefinition of SPDLOG_HEADER_ONLY
 DEFINES += SPDLOG_HEADER_ONLY
 
+# Release builds compile LOGIX_TRACE/LOGIX_DEBUG and their LOGIX_BIN_* counterparts away
+CONFIG(release, debug|release): DEFINES += LOGIX_ACTIVE_LEVEL=SPDLOG_LEVEL_INFO
+
 # Include paths for spdlog and nlohmann/json (changed to relative paths)
 INCLUDEPATH += $$PWD/spdlog/include
 INCLUDEPATH += $$PWD/nlohmann/include
 
+# zlib compresses rotated log files
+LIBS += -lz
+
 SOURCES += \
+    asyncpipeline.cpp \
+    asyncsink.cpp \
+    binaryformat.cpp \
+    binarylog.cpp \
+    consolesink.cpp \
+    crashring.cpp \
+    dedupsink.cpp \
+    fanoutsink.cpp \
+    flightrecorder.cpp \
+    flushpolicy.cpp \
+    jsonwriter.cpp \
+    levelgate.cpp \
+    logclock.cpp \
     loggerfacade.cpp \
-    main.cpp
+    main.cpp \
+    overflowguard.cpp \
+    payloadpool.cpp \
+    prioritylane.cpp \
+    queuebudget.cpp \
+    rotatingfilesink.cpp \
+    spscstaging.cpp \
+    threadtuning.cpp \
+    timestampcache.cpp \
+    udpsink.cpp \
+    udptransport.cpp
 
 HEADERS += \
-    loggerfacade.h
+    activelevel.h \
+    asyncpipeline.h \
+    asyncsink.h \
+    binaryformat.h \
+    binarylog.h \
+    consolesink.h \
+    crashring.h \
+    crashringformat.h \
+    dedupsink.h \
+    eventcount.h \
+    fanoutsink.h \
+    flightrecorder.h \
+    flushpolicy.h \
+    formattedsink.h \
+    jsonwriter.h \
+    levelgate.h \
+    logclock.h \
+    loggerfacade.h \
+    mpscring.h \
+    overflowguard.h \
+    payloadpool.h \
+    prioritylane.h \
+    queuebudget.h \
+    rotatingfilesink.h \
+    sampling.h \
+    spscring.h \
+    spscstaging.h \
+    threadtuning.h \
+    timestampcache.h \
+    udpsink.h \
+    udptransport.h
 
 # Default rules for deployment
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -0,0 +1,9 @@
+#pragma once
+#include <spdlog/common.h>
+
+// Build-time floor of the LOGIX_* and LOGIX_BIN_* macros: calls below it are
+// removed by the preprocessor, arguments and level check included. Takes
+// spdlog's level numbers, e.g. -DLOGIX_ACTIVE_LEVEL=SPDLOG_LEVEL_INFO.
+#ifndef LOGIX_ACTIVE_LEVEL
+#define LOGIX_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
@@ -0,0 +1,277 @@
+#include "asyncpipeline.h"
+#include "threadtuning.h"
+
+namespace Logging {
+
+namespace {
+
+// How long the worker sleeps before re-checking an idle queue
+constexpr std::chrono::milliseconds kIdleWait{100};
+
+// Spins before a producer facing a full ring goes to sleep
+constexpr int kFullRingSpins = 64;
+
+// Producer threads are numbered in the order they first log
+std::atomic<size_t> nextProducer{0};
+
+} // namespace
+
+size_t producerShard(size_t shards) {
+    if (shards <= 1) {
+        return 0;
+    }
+    thread_local const size_t producer = nextProducer.fetch_add(1, std::memory_order_relaxed);
+    return producer % shards;
+}
+
+bool MpscRecordQueue::push(const spdlog::details::log_msg& msg, spdlog::async_overflow_policy policy) {
+    auto fill = [this, &msg](AsyncRecord& rec) {
+        rec.kind = AsyncRecord::Kind::Log;
+        rec.msg.assign(msg, pool_.get());
+        rec.budgeted = true;
+    };
+    if (!ring_.tryPush(fill)) {
+        if (policy != spdlog::async_overflow_policy::block) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        pushBlocking(fill);
+    }
+    notEmpty_.notifyOne();
+    return true;
+}
+
+void MpscRecordQueue::pushControl(AsyncRecord::Kind kind) {
+    auto fill = [kind](AsyncRecord& rec) {
+        rec.kind = kind;
+        rec.budgeted = false;
+    };
+    if (!ring_.tryPush(fill)) {
+        pushBlocking(fill);
+    }
+    notEmpty_.notifyOne();
+}
+
+template <typename Fill>
+void MpscRecordQueue::pushBlocking(Fill&& fill) {
+    for (int spin = 0; spin < kFullRingSpins; ++spin) {
+        std::this_thread::yield();
+        if (ring_.tryPush(fill)) {
+            return;
+        }
+    }
+    for (;;) {
+        uint32_t key = notFull_.prepareWait();
+        if (ring_.tryPush(fill)) {
+            notFull_.cancelWait();
+            return;
+        }
+        notFull_.wait(key, kIdleWait);
+    }
+}
+
+bool MpscRecordQueue::pop(AsyncRecord& out, std::chrono::milliseconds timeout) {
+    auto take = [&out](AsyncRecord& rec) {
+        out = std::move(rec);
+    };
+    if (!ring_.tryPop(take)) {
+        uint32_t key = notEmpty_.prepareWait();
+        if (ring_.tryPop(take)) {
+            notEmpty_.cancelWait();
+        } else {
+            notEmpty_.wait(key, timeout);
+            if (!ring_.tryPop(take)) {
+                return false;
+            }
+        }
+    }
+    notFull_.notifyAll();
+    return true;
+}
+
+AsyncPipeline::AsyncPipeline(std::vector<std::unique_ptr<RecordQueue>> queues, std::shared_ptr<QueueBudget> budget)
+    : queues_(std::move(queues)), budget_(std::move(budget)) {}
+
+AsyncPipeline::~AsyncPipeline() {
+    stop();
+}
+
+void AsyncPipeline::start(QueuedLogger* backend) {
+    backend_ = backend;
+    for (size_t shard = 0; shard < queues_.size(); ++shard) {
+        workers_.emplace_back([this, shard]() { run(shard); });
+    }
+}
+
+void AsyncPipeline::stop() {
+    if (!workers_.empty()) {
+        pushControl(AsyncRecord::Kind::Stop);
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+        workers_.clear();
+    }
+}
+
+void AsyncPipeline::pushControl(AsyncRecord::Kind kind) {
+    for (auto& queue : queues_) {
+        queue->pushControl(kind);
+    }
+}
+
+size_t AsyncPipeline::size() const {
+    size_t total = 0;
+    for (const auto& queue : queues_) {
+        total += queue->size();
+    }
+    return total;
+}
+
+size_t AsyncPipeline::capacity() const {
+    size_t total = 0;
+    for (const auto& queue : queues_) {
+        total += queue->capacity();
+    }
+    return total;
+}
+
+size_t AsyncPipeline::producerCapacity() {
+    return sharedBound() ? capacity() : queue().capacity();
+}
+
+size_t AsyncPipeline::producerBacklog() {
+    return sharedBound() ? size() : queue().localSize();
+}
+
+void AsyncPipeline::run(size_t shard) {
+    tuneCurrentThread("worker" + std::to_string(shard));
+    RecordQueue& queue = *queues_[shard];
+    AsyncRecord rec;
+    bool summaryDue = false; // Drops are pending; report them once the queue runs empty
+    for (;;) {
+        if (!queue.pop(rec, summaryDue ? std::chrono::milliseconds(0) : kIdleWait)) {
+            if (summaryDue) {
+                backend_->backendDrained(shard);
+                summaryDue = false;
+            }
+            continue;
+        }
+        switch (rec.kind) {
+        case AsyncRecord::Kind::Log:
+            backend_->backendLog(rec.msg.msg(), shard);
+            if (budget_ && rec.budgeted) {
+                budget_->release(rec.msg.msg().payload.size());
+            }
+            summaryDue = backend_->dropsPending();
+            break;
+        case AsyncRecord::Kind::Flush:
+            backend_->backendFlush(shard);
+            break;
+        case AsyncRecord::Kind::Stop:
+            return;
+        }
+    }
+}
+
+std::shared_ptr<spdlog::logger> QueuedLogger::clone(std::string logger_name) {
+    auto cloned = std::make_shared<QueuedLogger>(*this);
+    cloned->name_ = std::move(logger_name);
+    return cloned;
+}
+
+void QueuedLogger::backendLog(const spdlog::details::log_msg& msg, size_t shard) {
+    auto logTo = [this, &msg](const spdlog::sink_ptr& sink) {
+        if (sink->should_log(msg.level)) {
+            try {
+                sink->log(msg);
+            } catch (const std::exception& ex) {
+                err_handler_(ex.what());
+            }
+        }
+    };
+    if (pipeline_->workers() > 1) {
+        logTo(sinks_[shard]);
+    } else {
+        for (auto& sink : sinks_) {
+            logTo(sink);
+        }
+    }
+    if (should_flush_(msg)) {
+        backendFlush(shard);
+    }
+}
+
+void QueuedLogger::backendFlush(size_t shard) {
+    auto flushSink = [this](const spdlog::sink_ptr& sink) {
+        try {
+            sink->flush();
+        } catch (const std::exception& ex) {
+            err_handler_(ex.what());
+        }
+    };
+    if (pipeline_->workers() > 1) {
+        flushSink(sinks_[shard]);
+    } else {
+        for (auto& sink : sinks_) {
+            flushSink(sink);
+        }
+    }
+}
+
+void QueuedLogger::backendDrained(size_t shard) {
+    postDropSummary(*guard_, [this, shard](const spdlog::details::log_msg& summary) {
+        backendLog(summary, shard);
+    }, true);
+}
+
+void QueuedLogger::sink_it_(const spdlog::details::log_msg& msg) {
+    if (crashRing_) {
+        crashRing_->log(msg);
+    }
+    if (priorityLane_ && priorityLane_->accepts(msg.level)) {
+        priorityLane_->log(msg);
+        return;
+    }
+    if (!guard_) {
+        enqueue(msg, overflowPolicy_);
+        return;
+    }
+    postDropSummary(*guard_, [this](const spdlog::details::log_msg& summary) {
+        enqueue(summary, spdlog::async_overflow_policy::block);
+    });
+    if (!guard_->admit(msg.level)) {
+        return;
+    }
+    // Droppable records never wait, not even for a full per-thread ring
+    auto policy = guard_->blocks(msg.level) ? spdlog::async_overflow_policy::block
+                                            : spdlog::async_overflow_policy::overrun_oldest;
+    if (!enqueue(msg, policy)) {
+        guard_->countDrop(msg.level);
+    }
+}
+
+bool QueuedLogger::enqueue(const spdlog::details::log_msg& msg, spdlog::async_overflow_policy policy) {
+    RecordQueue& queue = pipeline_->queue();
+    QueueBudget* budget = pipeline_->budget();
+    if (!budget) {
+        return queue.push(msg, policy);
+    }
+    spdlog::details::log_msg queued = budget->fit(msg);
+    size_t bytes = queued.payload.size();
+    if (policy == spdlog::async_overflow_policy::block) {
+        budget->acquire(bytes);
+    } else if (!budget->tryAcquire(bytes, false)) {
+        return false;
+    }
+    if (!queue.push(queued, policy)) {
+        budget->release(bytes);
+        return false;
+    }
+    return true;
+}
+
+void QueuedLogger::flush_() {
+    pipeline_->pushControl(AsyncRecord::Kind::Flush);
+}
+
+} // namespace Logging
@@ -0,0 +1,197 @@
+#pragma once
+#include "crashring.h"
+#include "eventcount.h"
+#include "mpscring.h"
+#include "payloadpool.h"
+#include "overflowguard.h"
+#include "prioritylane.h"
+#include "queuebudget.h"
+#include <spdlog/logger.h>
+#include <spdlog/async_logger.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Logging {
+
+// A unit of work queued for the async worker
+struct AsyncRecord {
+    enum class Kind : uint8_t { Log, Flush, Stop };
+    Kind kind = Kind::Log;
+    PooledMessage msg; // Owns copies of the logger name and payload
+    bool budgeted = false; // Holds its payload size against the pipeline's QueueBudget
+};
+
+// Queue engine between the producer threads and the pipeline's worker
+class RecordQueue {
+public:
+    virtual ~RecordQueue() = default;
+
+    // Producer side; returns false if the record was dropped. The record holds
+    // its payload size against the pipeline's budget until the worker takes it.
+    virtual bool push(const spdlog::details::log_msg& msg, spdlog::async_overflow_policy policy) = 0;
+
+    // Enqueue a flush or stop marker, waiting for room if necessary
+    virtual void pushControl(AsyncRecord::Kind kind) = 0;
+
+    // Consumer side, single worker thread; false if nothing arrived within timeout
+    virtual bool pop(AsyncRecord& out, std::chrono::milliseconds timeout) = 0;
+
+    virtual size_t size() const = 0;
+    virtual size_t dropped() const = 0;
+
+    // Records the queue holds at most; per producer thread if it has no shared bound
+    virtual size_t capacity() const = 0;
+
+    // False if producers fill separate rings rather than one shared one
+    virtual bool sharedBound() const { return true; }
+
+    // Records queued against the calling thread's bound
+    virtual size_t localSize() const { return size(); }
+};
+
+// Lock-free bounded MPSC ring. The worker sleeps on a futex when the ring is empty
+// and producers only make a syscall when the worker is actually asleep. Under
+// async_overflow_policy::overrun_oldest a full ring drops the new record instead,
+// since producers cannot safely evict the consumer's oldest slot.
+class MpscRecordQueue : public RecordQueue {
+public:
+    // pool, if given, holds payloads too large for a slot
+    MpscRecordQueue(size_t capacity, std::shared_ptr<PayloadPool> pool)
+        : pool_(std::move(pool)), ring_(capacity) {}
+
+    bool push(const spdlog::details::log_msg& msg, spdlog::async_overflow_policy policy) override;
+    void pushControl(AsyncRecord::Kind kind) override;
+    bool pop(AsyncRecord& out, std::chrono::milliseconds timeout) override;
+    size_t size() const override { return ring_.size(); }
+    size_t dropped() const override { return dropped_.load(std::memory_order_relaxed); }
+    size_t capacity() const override { return ring_.capacity(); }
+
+private:
+    template <typename Fill>
+    void pushBlocking(Fill&& fill);
+
+    std::shared_ptr<PayloadPool> pool_; // Outlives the slots
+    MpscRing<AsyncRecord> ring_;
+    EventCount notEmpty_; // Worker waits here
+    EventCount notFull_;  // Blocked producers wait here
+    std::atomic<size_t> dropped_{0};
+};
+
+class QueuedLogger;
+
+// Index of the calling thread among producers, stable for the thread's lifetime.
+// Sharded queues use it so that all records of a thread take the same path.
+size_t producerShard(size_t shards);
+
+// Owns the record queues and a worker thread per queue that hands records to the
+// sinks. Each producer thread always uses the same queue, so the records of one
+// thread keep their order; records of different threads may be delivered in a
+// different order than they were logged.
+class AsyncPipeline {
+public:
+    // budget, if given, bounds the payload bytes of queued records in all queues
+    explicit AsyncPipeline(std::vector<std::unique_ptr<RecordQueue>> queues,
+                           std::shared_ptr<QueueBudget> budget = nullptr);
+    ~AsyncPipeline();
+
+    AsyncPipeline(const AsyncPipeline&) = delete;
+    AsyncPipeline& operator=(const AsyncPipeline&) = delete;
+
+    // The backend logger dispatches records to the sinks and must outlive stop()
+    void start(QueuedLogger* backend);
+
+    // Deliver everything already queued, then join the workers
+    void stop();
+
+    size_t workers() const { return queues_.size(); }
+
+    // The calling thread's queue
+    RecordQueue& queue() { return *queues_[producerShard(queues_.size())]; }
+
+    // Enqueue a flush or stop marker on every queue
+    void pushControl(AsyncRecord::Kind kind);
+
+    QueueBudget* budget() { return budget_.get(); }
+
+    // Summed over the queues
+    size_t size() const;
+    size_t capacity() const;
+
+    bool sharedBound() const { return queues_.front()->sharedBound(); }
+
+    // Bound and fill that the calling producer runs into: all queues together, or
+    // its own ring if producers have one each
+    size_t producerCapacity();
+    size_t producerBacklog();
+
+    // True when the workers have nothing left to deliver
+    bool drained() const { return size() == 0; }
+
+private:
+    void run(size_t shard);
+
+    std::vector<std::unique_ptr<RecordQueue>> queues_;
+    std::shared_ptr<QueueBudget> budget_;
+    QueuedLogger* backend_ = nullptr;
+    std::vector<std::thread> workers_;
+};
+
+// spdlog logger whose records travel through an AsyncPipeline instead of the
+// global spdlog thread pool. With several pipeline workers, worker i drives only
+// the logger's sink i, which must then be one per worker.
+class QueuedLogger : public spdlog::logger {
+public:
+    template <typename It>
+    QueuedLogger(std::string name, It begin, It end, std::shared_ptr<AsyncPipeline> pipeline,
+                 spdlog::async_overflow_policy overflowPolicy = spdlog::async_overflow_policy::block)
+        : spdlog::logger(std::move(name), begin, end),
+          pipeline_(std::move(pipeline)),
+          overflowPolicy_(overflowPolicy) {}
+
+    std::shared_ptr<spdlog::logger> clone(std::string logger_name) override;
+
+    // Level-aware overflow handling; replaces the fixed overflow policy
+    void setOverflowGuard(std::shared_ptr<LevelOverflowGuard> guard) {
+        guard_ = std::move(guard);
+    }
+
+    // Records the lane accepts skip the queue
+    void setPriorityLane(std::shared_ptr<PriorityLane> lane) {
+        priorityLane_ = std::move(lane);
+    }
+
+    // Every record is written here on the logging thread, before it is queued
+    void setCrashRing(std::shared_ptr<CrashRingSink> ring) {
+        crashRing_ = std::move(ring);
+    }
+
+    // Worker side, shard being the worker's index
+    void backendLog(const spdlog::details::log_msg& msg, size_t shard);
+    void backendFlush(size_t shard);
+
+    // True if the guard holds drops no summary has reported yet
+    bool dropsPending() const { return guard_ && guard_->pendingDrops(); }
+
+    // The worker found its queue empty: report what was dropped meanwhile
+    void backendDrained(size_t shard);
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override;
+    void flush_() override;
+
+private:
+    // Queue msg within the pipeline's budget; false if it was dropped
+    bool enqueue(const spdlog::details::log_msg& msg, spdlog::async_overflow_policy policy);
+
+    std::shared_ptr<AsyncPipeline> pipeline_;
+    spdlog::async_overflow_policy overflowPolicy_;
+    std::shared_ptr<LevelOverflowGuard> guard_;
+    std::shared_ptr<PriorityLane> priorityLane_;
+    std::shared_ptr<CrashRingSink> crashRing_;
+};
+
+} // namespace Logging
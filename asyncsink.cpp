@@ -0,0 +1,287 @@
+#include "asyncsink.h"
+#include "threadtuning.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace Logging {
+
+namespace {
+
+constexpr std::chrono::milliseconds kIdleWait{100};
+constexpr int kFullRingSpins = 64;
+constexpr size_t kPriorityCapacity = 256;
+
+} // namespace
+
+AsyncSink::AsyncSink(std::string name, size_t capacity, SinkOverflow overflow,
+                     std::shared_ptr<PayloadPool> pool, size_t byteLimit)
+    : name_(std::move(name)), overflow_(overflow), pool_(std::move(pool)),
+      budget_(byteLimit > 0 ? std::make_unique<QueueBudget>(byteLimit, 0) : nullptr), ring_(capacity),
+      priorityRing_(kPriorityCapacity) {}
+
+AsyncSink::~AsyncSink() {
+    stop();
+}
+
+void AsyncSink::setPriority(spdlog::level::level_enum level, bool waitForFlush,
+                            std::shared_ptr<PriorityLatency> latency) {
+    priorityLevel_ = level;
+    waitForPriority_ = waitForFlush;
+    latency_ = std::move(latency);
+}
+
+void AsyncSink::start(spdlog::sink_ptr target) {
+    target_ = std::move(target);
+    formattedTarget_ = std::dynamic_pointer_cast<FormattedSink>(target_);
+    target_->set_level(spdlog::level::trace);
+    running_.store(true);
+    worker_ = std::thread([this]() { run(); });
+}
+
+void AsyncSink::stop() {
+    if (worker_.joinable()) {
+        push(ring_, [](SinkRecord& rec) { rec.kind = AsyncRecord::Kind::Stop; }, true);
+        worker_.join();
+        running_.store(false);
+        priorityDone_.notifyAll();
+    }
+}
+
+std::function<bool()> AsyncSink::drainedProbe() {
+    std::weak_ptr<AsyncSink> weakSink = weak_from_this();
+    return [weakSink]() {
+        auto sink = weakSink.lock();
+        return !sink || sink->ring_.size() == 0;
+    };
+}
+
+void AsyncSink::log(const spdlog::details::log_msg& msg) {
+    pushLog(msg, nullptr);
+}
+
+void AsyncSink::logFormatted(const spdlog::details::log_msg& msg, const FormattedRecordPtr& record) {
+    pushLog(msg, record);
+}
+
+void AsyncSink::flush() {
+    auto fill = [](SinkRecord& rec) {
+        rec.kind = AsyncRecord::Kind::Flush;
+        rec.done = nullptr;
+    };
+    if (overflow_ == SinkOverflow::Block) {
+        push(ring_, fill, true);
+        return;
+    }
+    // Flushes come from the shared worker, which must not wait on this sink; the
+    // worker here flushes once it has drained what is queued
+    if (!ring_.tryPush(fill)) {
+        flushPending_.store(true, std::memory_order_relaxed);
+    }
+    notEmpty_.notifyOne();
+}
+
+void AsyncSink::set_pattern(const std::string& pattern) {
+    target_->set_pattern(pattern);
+}
+
+void AsyncSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) {
+    target_->set_formatter(std::move(sink_formatter));
+}
+
+void AsyncSink::pushLog(const spdlog::details::log_msg& msg, const FormattedRecordPtr& record) {
+    auto fill = [this, &msg, &record](SinkRecord& rec) {
+        rec.kind = AsyncRecord::Kind::Log;
+        rec.msg.assign(msg, pool_.get());
+        rec.formatted = record;
+    };
+    bool priority = msg.level >= priorityLevel_;
+    bool block = priority || overflow_ == SinkOverflow::Block;
+    size_t budgeted = 0;
+    if (budget_) {
+        // The payload copy and the rendered text, which sinks of one pattern share
+        size_t bytes = msg.payload.size();
+        if (record) {
+            bytes += record->text.size();
+        }
+        budgeted = std::min(bytes, budget_->limit());
+        if (block) {
+            budget_->acquire(budgeted);
+        } else if (!budget_->tryAcquire(budgeted, true)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    if (!priority) {
+        bool pushed = push(ring_, [&fill, budgeted](SinkRecord& rec) {
+            fill(rec);
+            rec.done = nullptr;
+            rec.budgeted = budgeted;
+        }, block);
+        if (!pushed && budget_) {
+            budget_->release(budgeted);
+        }
+        return;
+    }
+    // Priority records are never dropped
+    std::atomic<bool> done{false};
+    bool wait = waitForPriority_ && running_.load(std::memory_order_relaxed);
+    push(priorityRing_, [&fill, &done, wait, budgeted](SinkRecord& rec) {
+        fill(rec);
+        rec.done = wait ? &done : nullptr;
+        rec.budgeted = budgeted;
+    }, true);
+    while (wait && !done.load(std::memory_order_acquire)) {
+        uint32_t key = priorityDone_.prepareWait();
+        if (done.load(std::memory_order_acquire) || !running_.load(std::memory_order_relaxed)) {
+            priorityDone_.cancelWait();
+            break;
+        }
+        priorityDone_.wait(key, kIdleWait);
+    }
+}
+
+template <typename Fill>
+bool AsyncSink::push(MpscRing<SinkRecord>& ring, Fill&& fill, bool block) {
+    if (!ring.tryPush(fill)) {
+        if (!block) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        bool pushed = false;
+        for (int spin = 0; spin < kFullRingSpins && !pushed; ++spin) {
+            std::this_thread::yield();
+            pushed = ring.tryPush(fill);
+        }
+        while (!pushed) {
+            uint32_t key = notFull_.prepareWait();
+            if (ring.tryPush(fill)) {
+                notFull_.cancelWait();
+                break;
+            }
+            notFull_.wait(key, kIdleWait);
+        }
+    }
+    notEmpty_.notifyOne();
+    return true;
+}
+
+void AsyncSink::run() {
+    tuneCurrentThread(name_);
+    SinkRecord rec;
+    for (;;) {
+        if (!tryTake(rec)) {
+            reportDropped();
+            if (flushPending_.exchange(false, std::memory_order_relaxed)) {
+                SinkRecord flushRec;
+                flushRec.kind = AsyncRecord::Kind::Flush;
+                deliver(flushRec);
+            }
+            std::chrono::milliseconds wait = serveDeadline();
+            uint32_t key = notEmpty_.prepareWait();
+            if (tryTake(rec)) {
+                notEmpty_.cancelWait();
+            } else {
+                notEmpty_.wait(key, wait);
+                continue;
+            }
+        }
+        notFull_.notifyAll();
+        if (rec.kind == AsyncRecord::Kind::Stop) {
+            reportDropped();
+            target_->flush();
+            return;
+        }
+        deliver(rec);
+        rec.formatted.reset(); // Let the fanout reuse its buffer
+        releaseBudget(rec);
+    }
+}
+
+// Priority records first, each flushed on its own
+bool AsyncSink::tryTake(SinkRecord& rec) {
+    auto take = [&rec](SinkRecord& slot) {
+        rec = std::move(slot);
+    };
+    while (priorityRing_.tryPop(take)) {
+        deliverPriority(rec);
+    }
+    return ring_.tryPop(take);
+}
+
+// Expire the target if its deadline has passed; how long the idle worker may sleep
+std::chrono::milliseconds AsyncSink::serveDeadline() {
+    if (!formattedTarget_) {
+        return kIdleWait;
+    }
+    try {
+        auto deadline = formattedTarget_->deadline();
+        auto now = spdlog::log_clock::now();
+        if (deadline <= now) {
+            formattedTarget_->expire();
+            deadline = formattedTarget_->deadline();
+        }
+        if (deadline - now < kIdleWait) {
+            // Rounded up, so the worker does not wake just short of it
+            return std::max(std::chrono::ceil<std::chrono::milliseconds>(deadline - now),
+                            std::chrono::milliseconds(1));
+        }
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "[*** LOG ERROR ***] [%s sink] %s\n", name_.c_str(), ex.what());
+    }
+    return kIdleWait;
+}
+
+void AsyncSink::deliverPriority(SinkRecord& rec) {
+    deliver(rec);
+    try {
+        target_->flush();
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "[*** LOG ERROR ***] [%s sink] %s\n", name_.c_str(), ex.what());
+    }
+    if (latency_) {
+        latency_->record(rec.msg.msg().time);
+    }
+    if (rec.done) {
+        rec.done->store(true, std::memory_order_release);
+        priorityDone_.notifyAll();
+    }
+    rec.formatted.reset();
+    releaseBudget(rec);
+    notFull_.notifyAll();
+}
+
+void AsyncSink::deliver(SinkRecord& rec) {
+    try {
+        if (rec.kind == AsyncRecord::Kind::Flush) {
+            target_->flush();
+        } else if (rec.formatted && formattedTarget_) {
+            formattedTarget_->logFormatted(rec.msg.msg(), rec.formatted);
+        } else {
+            target_->log(rec.msg.msg());
+        }
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "[*** LOG ERROR ***] [%s sink] %s\n", name_.c_str(), ex.what());
+    }
+}
+
+// Flush and stop records reuse slots without setting budgeted
+void AsyncSink::releaseBudget(SinkRecord& rec) {
+    if (budget_ && rec.kind == AsyncRecord::Kind::Log) {
+        budget_->release(rec.budgeted);
+    }
+}
+
+// Tell the sink itself how many of its records were lost, once it has caught up
+void AsyncSink::reportDropped() {
+    size_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped == reportedDropped_) {
+        return;
+    }
+    std::string text = fmt::format("{} sink queue full, dropped {} log records", name_, dropped - reportedDropped_);
+    reportedDropped_ = dropped;
+    SinkRecord report;
+    report.msg.assign(spdlog::details::log_msg("logix", spdlog::level::warn, text), nullptr);
+    deliver(report);
+}
+
+} // namespace Logging
@@ -0,0 +1,112 @@
+#pragma once
+#include "asyncpipeline.h"
+#include "formattedsink.h"
+#include "prioritylane.h"
+#include "queuebudget.h"
+#include <functional>
+
+namespace Logging {
+
+// A record queued for one sink's worker
+struct SinkRecord {
+    AsyncRecord::Kind kind = AsyncRecord::Kind::Log;
+    PooledMessage msg;
+    FormattedRecordPtr formatted; // Shared with the other sinks of the pattern, if any
+    std::atomic<bool>* done = nullptr; // Set once a priority record is flushed, for a waiting producer
+    size_t budgeted = 0; // Bytes held against the sink's budget until delivered
+};
+
+// What a full sink queue does with a record
+enum class SinkOverflow {
+    Block,     // The caller waits for room
+    DiscardNew // The incoming record is dropped, queued ones are kept
+};
+
+// Runs a sink on its own queue and worker thread, so a slow sink only lags or
+// drops its own records. Under SinkOverflow::Block a full queue makes the caller
+// wait; otherwise the record is dropped, counted and reported to the sink once
+// its queue has drained. A flush that finds the queue full is then not queued
+// either: the worker flushes once it has caught up.
+//
+// With a byte limit, queued records also hold their payload and rendered bytes
+// until delivered, and a full budget is handled like a full queue; a record
+// larger than the limit takes all of it.
+//
+// Records at or above the priority level go through a second ring that the worker
+// always drains first, and are flushed as soon as they are written.
+//
+// Construct, hand drainedProbe() to the wrapped sink if it wants one, then start().
+class AsyncSink : public FormattedSink, public std::enable_shared_from_this<AsyncSink> {
+public:
+    // pool, if given, holds payloads too large for a slot; byteLimit, if not 0,
+    // bounds the bytes of queued records
+    AsyncSink(std::string name, size_t capacity, SinkOverflow overflow,
+              std::shared_ptr<PayloadPool> pool = nullptr, size_t byteLimit = 0);
+    ~AsyncSink() override;
+
+    AsyncSink(const AsyncSink&) = delete;
+    AsyncSink& operator=(const AsyncSink&) = delete;
+
+    // Call before start(). With waitForFlush the logging thread blocks until its
+    // priority record is flushed; latency, if given, records the time it took.
+    void setPriority(spdlog::level::level_enum level, bool waitForFlush, std::shared_ptr<PriorityLatency> latency);
+
+    // Level filtering moves to this sink, the target sees everything it is given
+    void start(spdlog::sink_ptr target);
+
+    // Deliver everything already queued, then join the worker
+    void stop();
+
+    // True when this sink's queue has been emptied
+    std::function<bool()> drainedProbe();
+
+    size_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // Records it can hold at once: both rings plus the one being delivered
+    size_t capacity() const { return ring_.capacity() + priorityRing_.capacity() + 1; }
+
+    // Bytes and records held against the byte limit; empty without one
+    QueueBudget::Gauge gauge() const { return budget_ ? budget_->gauge() : QueueBudget::Gauge(); }
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void logFormatted(const spdlog::details::log_msg& msg, const FormattedRecordPtr& record) override;
+    // Queued behind the records already logged, does not wait for them
+    void flush() override;
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+private:
+    template <typename Fill>
+    bool push(MpscRing<SinkRecord>& ring, Fill&& fill, bool block);
+    void pushLog(const spdlog::details::log_msg& msg, const FormattedRecordPtr& record);
+    void run();
+    bool tryTake(SinkRecord& rec);
+    void deliver(SinkRecord& rec);
+    void deliverPriority(SinkRecord& rec);
+    std::chrono::milliseconds serveDeadline();
+    void reportDropped();
+    void releaseBudget(SinkRecord& rec);
+
+    std::string name_;
+    SinkOverflow overflow_;
+    std::shared_ptr<PayloadPool> pool_; // Outlives the slots
+    std::unique_ptr<QueueBudget> budget_; // Unset without a byte limit
+    MpscRing<SinkRecord> ring_;
+    MpscRing<SinkRecord> priorityRing_;
+    EventCount notEmpty_; // Either ring
+    EventCount notFull_;
+    EventCount priorityDone_;
+    spdlog::level::level_enum priorityLevel_ = spdlog::level::off;
+    bool waitForPriority_ = false;
+    std::shared_ptr<PriorityLatency> latency_;
+    std::atomic<bool> running_{false};
+    std::atomic<size_t> dropped_{0};
+    std::atomic<bool> flushPending_{false}; // A flush found the queue full
+    size_t reportedDropped_ = 0; // Worker side
+
+    spdlog::sink_ptr target_;
+    std::shared_ptr<FormattedSink> formattedTarget_;
+    std::thread worker_;
+};
+
+} // namespace Logging
@@ -0,0 +1,92 @@
+#include "binaryformat.h"
+#include <spdlog/fmt/fmt.h>
+#if defined(SPDLOG_FMT_EXTERNAL)
+#include <fmt/args.h>
+#else
+#include <spdlog/fmt/bundled/args.h>
+#endif
+#include <iterator>
+
+namespace Logging {
+namespace BinaryFormat {
+
+namespace {
+
+template <typename V>
+bool readScalar(const char*& pos, const char* end, V& value) {
+    if (static_cast<size_t>(end - pos) < sizeof(V)) {
+        return false;
+    }
+    std::memcpy(&value, pos, sizeof(V));
+    pos += sizeof(V);
+    return true;
+}
+
+bool decodeArgs(const char* pos, const char* end, fmt::dynamic_format_arg_store<fmt::format_context>& store) {
+    while (pos < end) {
+        auto tag = static_cast<ArgTag>(*pos++);
+        switch (tag) {
+        case ArgTag::Int: {
+            int64_t value;
+            if (!readScalar(pos, end, value)) return false;
+            store.push_back(value);
+            break;
+        }
+        case ArgTag::UInt: {
+            uint64_t value;
+            if (!readScalar(pos, end, value)) return false;
+            store.push_back(value);
+            break;
+        }
+        case ArgTag::Double: {
+            double value;
+            if (!readScalar(pos, end, value)) return false;
+            store.push_back(value);
+            break;
+        }
+        case ArgTag::Bool: {
+            uint8_t value;
+            if (!readScalar(pos, end, value)) return false;
+            store.push_back(value != 0);
+            break;
+        }
+        case ArgTag::Char: {
+            char value;
+            if (!readScalar(pos, end, value)) return false;
+            store.push_back(value);
+            break;
+        }
+        case ArgTag::String: {
+            uint32_t length;
+            if (!readScalar(pos, end, length) || static_cast<size_t>(end - pos) < length) return false;
+            store.push_back(std::string(pos, length));
+            pos += length;
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool formatMessage(spdlog::string_view_t format, const char* args, size_t size, spdlog::memory_buf_t& out) {
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    size_t start = out.size();
+    if (decodeArgs(args, args + size, store)) {
+        try {
+            fmt::vformat_to(std::back_inserter(out), fmt::string_view(format.data(), format.size()), store);
+            return true;
+        } catch (const fmt::format_error&) {
+            out.resize(start);
+        }
+    }
+    out.append(format.data(), format.data() + format.size());
+    out.append(spdlog::string_view_t(" [undecodable arguments]"));
+    return false;
+}
+
+} // namespace BinaryFormat
+} // namespace Logging
@@ -0,0 +1,132 @@
+#pragma once
+#include <spdlog/common.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace Logging {
+
+// On-disk layout of binary log files, shared by the writer and logix-decode.
+//
+// A file is a sequence of sessions, each starting with a header:
+//     magic "LOGIXBIN", uint32 version, uint32 byte-order mark 0x01020304
+// followed by entries, each introduced by an EntryType byte:
+//     Site:    uint32 id, uint8 level, uint32 line, uint32 len + format, uint32 len + file
+//     Record:  uint32 site id, uint32 thread id, int64 epoch ns, uint16 len, uint8 truncated, encoded args
+//     Dropped: uint64 number of records lost because the queue was full
+// Integers use the writer's native byte order, checked through the mark.
+namespace BinaryFormat {
+
+constexpr char kMagic[8] = {'L', 'O', 'G', 'I', 'X', 'B', 'I', 'N'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+enum class EntryType : uint8_t { Site = 1, Record = 2, Dropped = 3 };
+
+// Each argument is a tag byte followed by its value
+enum class ArgTag : uint8_t { Int = 1, UInt = 2, Double = 3, Bool = 4, Char = 5, String = 6 };
+
+// Serializes arguments into a fixed buffer. Strings that do not fit are cut
+// short; scalars that do not fit are left out and the record is marked truncated.
+class ArgWriter {
+public:
+    ArgWriter(char* begin, size_t capacity) : begin_(begin), pos_(begin), end_(begin + capacity) {}
+
+    size_t size() const { return static_cast<size_t>(pos_ - begin_); }
+    bool truncated() const { return truncated_; }
+
+    void write(bool value) { writeScalar(ArgTag::Bool, static_cast<uint8_t>(value)); }
+    void write(char value) { writeScalar(ArgTag::Char, value); }
+    void write(float value) { writeScalar(ArgTag::Double, static_cast<double>(value)); }
+    void write(double value) { writeScalar(ArgTag::Double, value); }
+    void write(long double value) { writeScalar(ArgTag::Double, static_cast<double>(value)); }
+    void write(const char* value) { writeString(value ? value : "(null)", value ? std::strlen(value) : 6); }
+    void write(char* value) { write(static_cast<const char*>(value)); }
+    void write(const std::string& value) { writeString(value.data(), value.size()); }
+    void write(spdlog::string_view_t value) { writeString(value.data(), value.size()); }
+
+    // Render value with fmt straight into the remaining room, as a string argument
+    template <typename T>
+    void writeFormatted(const T& value) {
+        size_t room = static_cast<size_t>(end_ - pos_);
+        if (room < 1 + sizeof(uint32_t)) {
+            truncated_ = true;
+            return;
+        }
+        room -= 1 + sizeof(uint32_t);
+        char* text = pos_ + 1 + sizeof(uint32_t);
+        size_t size = fmt::format_to_n(text, room, "{}", value).size;
+        if (size > room) {
+            size = room;
+            truncated_ = true;
+        }
+        auto length = static_cast<uint32_t>(size);
+        *pos_++ = static_cast<char>(ArgTag::String);
+        std::memcpy(pos_, &length, sizeof(length));
+        pos_ = text + size;
+    }
+
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                      "binary logging supports integers, floating point, bool, char and strings only");
+        using Raw = typename std::conditional<std::is_enum<T>::value, std::underlying_type<T>, std::decay<T>>::type::type;
+        if (std::is_signed<Raw>::value) {
+            writeScalar(ArgTag::Int, static_cast<int64_t>(value));
+        } else {
+            writeScalar(ArgTag::UInt, static_cast<uint64_t>(value));
+        }
+    }
+
+private:
+    template <typename V>
+    void writeScalar(ArgTag tag, V value) {
+        if (static_cast<size_t>(end_ - pos_) < 1 + sizeof(V)) {
+            truncated_ = true;
+            return;
+        }
+        *pos_++ = static_cast<char>(tag);
+        std::memcpy(pos_, &value, sizeof(V));
+        pos_ += sizeof(V);
+    }
+
+    void writeString(const char* data, size_t size) {
+        size_t room = static_cast<size_t>(end_ - pos_);
+        if (room < 1 + sizeof(uint32_t)) {
+            truncated_ = true;
+            return;
+        }
+        room -= 1 + sizeof(uint32_t);
+        if (size > room) {
+            size = room;
+            truncated_ = true;
+        }
+        auto length = static_cast<uint32_t>(size);
+        *pos_++ = static_cast<char>(ArgTag::String);
+        std::memcpy(pos_, &length, sizeof(length));
+        pos_ += sizeof(length);
+        // Word by word: for a size it can bound, the compiler inlines a block
+        // copy whose startup alone costs more than most arguments take to copy
+        for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t)) {
+            std::memcpy(pos_, data, sizeof(uint64_t));
+            pos_ += sizeof(uint64_t);
+            data += sizeof(uint64_t);
+        }
+        std::memcpy(pos_, data, size);
+        pos_ += size;
+    }
+
+    char* begin_;
+    char* pos_;
+    char* end_;
+    bool truncated_ = false;
+};
+
+// Format a message from its format string and encoded arguments. Returns false,
+// with the raw format string and a marker in out, if the arguments do not match.
+bool formatMessage(spdlog::string_view_t format, const char* args, size_t size, spdlog::memory_buf_t& out);
+
+} // namespace BinaryFormat
+
+} // namespace Logging
@@ -0,0 +1,156 @@
+#include "binarylog.h"
+#include "threadtuning.h"
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+
+namespace Logging {
+
+namespace {
+
+constexpr std::chrono::milliseconds kIdleWait{100};
+
+// Call sites live for the whole process; a deque keeps references stable
+std::mutex& siteMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::deque<BinaryLogSite>& sites() {
+    static std::deque<BinaryLogSite> registered;
+    return registered;
+}
+
+template <typename V>
+void writeValue(std::FILE* file, V value) {
+    std::fwrite(&value, sizeof(V), 1, file);
+}
+
+void writeString(std::FILE* file, const char* text) {
+    auto length = static_cast<uint32_t>(std::strlen(text));
+    writeValue(file, length);
+    std::fwrite(text, 1, length, file);
+}
+
+} // namespace
+
+BinaryLogger& BinaryLogger::instance() {
+    static BinaryLogger logger;
+    return logger;
+}
+
+BinaryLogger::~BinaryLogger() {
+    stop();
+}
+
+uint32_t BinaryLogger::registerSite(spdlog::level::level_enum level, const char* format, const char* file, int line) {
+    std::lock_guard<std::mutex> lock(siteMutex());
+    sites().push_back(BinaryLogSite{level, format, file, line});
+    return static_cast<uint32_t>(sites().size() - 1);
+}
+
+void BinaryLogger::start(const std::string& path, size_t capacity, spdlog::level::level_enum level) {
+    if (running_.load()) {
+        return;
+    }
+    file_ = std::fopen(path.c_str(), "ab");
+    if (!file_) {
+        throw std::runtime_error("Cannot open binary log file: " + path);
+    }
+    // Every session starts with its own header and site dictionary
+    std::fwrite(BinaryFormat::kMagic, 1, sizeof(BinaryFormat::kMagic), file_);
+    writeValue(file_, BinaryFormat::kVersion);
+    writeValue(file_, BinaryFormat::kByteOrderMark);
+    sitesWritten_.clear();
+    droppedWritten_ = dropped_.load();
+
+    if (!ring_ || ring_->capacity() < capacity) {
+        ring_ = std::make_unique<MpscRing<BinaryRecord>>(capacity);
+    }
+    level_.store(level);
+    stopRequested_.store(false);
+    worker_ = std::thread([this]() { run(); });
+    running_.store(true, std::memory_order_release);
+}
+
+void BinaryLogger::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    stopRequested_.store(true);
+    notEmpty_.notifyOne();
+    worker_.join();
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+void BinaryLogger::run() {
+    tuneCurrentThread("binary");
+    auto write = [this](BinaryRecord& rec) { writeRecord(rec); };
+    for (;;) {
+        bool wrote = false;
+        while (ring_->tryPop(write)) {
+            wrote = true;
+        }
+        if (dropped_.load(std::memory_order_relaxed) != droppedWritten_) {
+            writeDropped();
+            wrote = true;
+        }
+        if (wrote) {
+            // End of a drain: hand the batch to the OS
+            std::fflush(file_);
+        }
+        if (stopRequested_.load()) {
+            if (ring_->front() == nullptr) {
+                return;
+            }
+            continue;
+        }
+        uint32_t key = notEmpty_.prepareWait();
+        if (ring_->front() != nullptr || stopRequested_.load()) {
+            notEmpty_.cancelWait();
+        } else {
+            notEmpty_.wait(key, kIdleWait);
+        }
+    }
+}
+
+void BinaryLogger::writeRecord(const BinaryRecord& rec) {
+    if (rec.siteId >= sitesWritten_.size() || !sitesWritten_[rec.siteId]) {
+        writeSite(rec.siteId);
+    }
+    writeValue(file_, static_cast<uint8_t>(BinaryFormat::EntryType::Record));
+    writeValue(file_, rec.siteId);
+    writeValue(file_, rec.threadId);
+    writeValue(file_, LogClock::toEpochNanos(rec.stamp));
+    writeValue(file_, rec.argsSize);
+    writeValue(file_, static_cast<uint8_t>(rec.truncated));
+    std::fwrite(rec.args, 1, rec.argsSize, file_);
+}
+
+void BinaryLogger::writeSite(uint32_t siteId) {
+    BinaryLogSite site;
+    {
+        std::lock_guard<std::mutex> lock(siteMutex());
+        site = sites().at(siteId);
+    }
+    writeValue(file_, static_cast<uint8_t>(BinaryFormat::EntryType::Site));
+    writeValue(file_, siteId);
+    writeValue(file_, static_cast<uint8_t>(site.level));
+    writeValue(file_, static_cast<uint32_t>(site.line));
+    writeString(file_, site.format);
+    writeString(file_, site.file);
+    if (siteId >= sitesWritten_.size()) {
+        sitesWritten_.resize(siteId + 1, false);
+    }
+    sitesWritten_[siteId] = true;
+}
+
+void BinaryLogger::writeDropped() {
+    size_t dropped = dropped_.load(std::memory_order_relaxed);
+    writeValue(file_, static_cast<uint8_t>(BinaryFormat::EntryType::Dropped));
+    writeValue(file_, static_cast<uint64_t>(dropped - droppedWritten_));
+    droppedWritten_ = dropped;
+}
+
+} // namespace Logging
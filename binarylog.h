@@ -0,0 +1,155 @@
+#pragma once
+#include "activelevel.h"
+#include "binaryformat.h"
+#include "eventcount.h"
+#include "logclock.h"
+#include "mpscring.h"
+#include <spdlog/details/os.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Logging {
+
+// A record as queued by the hot path: site id plus raw arguments, no formatting
+struct BinaryRecord {
+    static constexpr size_t kSize = 256;
+    static constexpr size_t kHeaderSize = sizeof(uint32_t) * 2 + sizeof(int64_t) + sizeof(uint16_t) * 2;
+    static constexpr size_t kMaxArgBytes = kSize - kHeaderSize;
+
+    uint32_t siteId;
+    uint32_t threadId;
+    int64_t stamp; // LogClock stamp, converted to epoch ns by the writer
+    uint16_t argsSize;
+    uint16_t truncated;
+    char args[kMaxArgBytes];
+};
+
+static_assert(sizeof(BinaryRecord) == BinaryRecord::kSize, "BinaryRecord must fill its slot exactly");
+
+// Static description of a binary logging call site, registered once per site
+struct BinaryLogSite {
+    spdlog::level::level_enum level;
+    const char* format;
+    const char* file;
+    int line;
+};
+
+// NanoLog-style deferred formatting. Call sites store a static format-string id
+// and their raw arguments in a lock-free ring; the worker appends them to a
+// compact binary file without formatting. logix-decode turns the files back into
+// text or JSON lines. Full rings drop records, which are counted in the file.
+class BinaryLogger {
+public:
+    static BinaryLogger& instance();
+
+    // Called once per call site through the LOGIX_BIN_* macros
+    static uint32_t registerSite(spdlog::level::level_enum level, const char* format, const char* file, int line);
+
+    // Throws std::runtime_error if the file cannot be opened
+    void start(const std::string& path, size_t capacity, spdlog::level::level_enum level);
+    void stop();
+
+    void setLevel(spdlog::level::level_enum level) {
+        level_.store(level, std::memory_order_relaxed);
+    }
+
+    bool shouldLog(spdlog::level::level_enum level) const {
+        return running_.load(std::memory_order_relaxed) && level >= level_.load(std::memory_order_relaxed);
+    }
+
+    template <typename... Args>
+    void log(uint32_t siteId, const Args&... args) {
+        int64_t stamp = LogClock::stamp();
+        bool pushed = ring_->tryPush([&](BinaryRecord& rec) {
+            rec.siteId = siteId;
+            rec.threadId = static_cast<uint32_t>(spdlog::details::os::thread_id());
+            rec.stamp = stamp;
+            BinaryFormat::ArgWriter writer(rec.args, sizeof(rec.args));
+            (void)std::initializer_list<int>{(writer.write(args), 0)...};
+            rec.argsSize = static_cast<uint16_t>(writer.size());
+            rec.truncated = writer.truncated() ? 1 : 0;
+        });
+        if (pushed) {
+            notEmpty_.notifyOne();
+        } else {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    BinaryLogger() = default;
+    ~BinaryLogger();
+
+    void run();
+    void writeRecord(const BinaryRecord& rec);
+    void writeSite(uint32_t siteId);
+    void writeDropped();
+
+    std::atomic<bool> running_{false};
+    std::atomic<int> level_{spdlog::level::info};
+    std::unique_ptr<MpscRing<BinaryRecord>> ring_;
+    EventCount notEmpty_;
+    std::atomic<size_t> dropped_{0};
+    std::atomic<bool> stopRequested_{false};
+    std::thread worker_;
+
+    // Worker side
+    std::FILE* file_ = nullptr;
+    std::vector<bool> sitesWritten_;
+    size_t droppedWritten_ = 0;
+};
+
+} // namespace Logging
+
+// Binary logging macros. The format string must be a literal; arguments are only
+// evaluated when the level is enabled and binary mode is active.
+#define LOGIX_BIN_LOG(level, format, ...)                                                                   \
+    do {                                                                                                    \
+        if (::Logging::BinaryLogger::instance().shouldLog(level)) {                                          \
+            static const uint32_t logixBinSite_ =                                                           \
+                ::Logging::BinaryLogger::registerSite(level, format, __FILE__, __LINE__);                    \
+            ::Logging::BinaryLogger::instance().log(logixBinSite_, ##__VA_ARGS__);                           \
+        }                                                                                                   \
+    } while (0)
+
+#if LOGIX_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define LOGIX_BIN_TRACE(format, ...) LOGIX_BIN_LOG(spdlog::level::trace, format, ##__VA_ARGS__)
+#else
+#define LOGIX_BIN_TRACE(format, ...) (void)0
+#endif
+
+#if LOGIX_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define LOGIX_BIN_DEBUG(format, ...) LOGIX_BIN_LOG(spdlog::level::debug, format, ##__VA_ARGS__)
+#else
+#define LOGIX_BIN_DEBUG(format, ...) (void)0
+#endif
+
+#if LOGIX_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define LOGIX_BIN_INFO(format, ...) LOGIX_BIN_LOG(spdlog::level::info, format, ##__VA_ARGS__)
+#else
+#define LOGIX_BIN_INFO(format, ...) (void)0
+#endif
+
+#if LOGIX_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
+#define LOGIX_BIN_WARN(format, ...) LOGIX_BIN_LOG(spdlog::level::warn, format, ##__VA_ARGS__)
+#else
+#define LOGIX_BIN_WARN(format, ...) (void)0
+#endif
+
+#if LOGIX_ACTIVE_LEVEL <= SPDLOG_LEVEL_ERROR
+#define LOGIX_BIN_ERROR(format, ...) LOGIX_BIN_LOG(spdlog::level::err, format, ##__VA_ARGS__)
+#else
+#define LOGIX_BIN_ERROR(format, ...) (void)0
+#endif
+
+#if LOGIX_ACTIVE_LEVEL <= SPDLOG_LEVEL_CRITICAL
+#define LOGIX_BIN_CRITICAL(format, ...) LOGIX_BIN_LOG(spdlog::level::critical, format, ##__VA_ARGS__)
+#else
+#define LOGIX_BIN_CRITICAL(format, ...) (void)0
+#endif
@@ -0,0 +1,70 @@
+#include "consolesink.h"
+#include <spdlog/details/os.h>
+#include <spdlog/pattern_formatter.h>
+
+namespace Logging {
+
+namespace {
+
+const spdlog::string_view_t kReset = "\033[m";
+
+} // namespace
+
+ConsoleSink::ConsoleSink()
+    : file_(stdout),
+      useColors_(spdlog::details::os::in_terminal(stdout) && spdlog::details::os::is_color_terminal()),
+      formatter_(std::make_unique<spdlog::pattern_formatter>()) {
+    // Same palette as spdlog's ansicolor sink
+    colors_[spdlog::level::trace] = "\033[37m";
+    colors_[spdlog::level::debug] = "\033[36m";
+    colors_[spdlog::level::info] = "\033[32m";
+    colors_[spdlog::level::warn] = "\033[33m\033[1m";
+    colors_[spdlog::level::err] = "\033[31m\033[1m";
+    colors_[spdlog::level::critical] = "\033[1m\033[41m";
+    colors_[spdlog::level::off] = kReset;
+}
+
+void ConsoleSink::log(const spdlog::details::log_msg& msg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    formatted_.clear();
+    msg.color_range_start = 0;
+    msg.color_range_end = 0;
+    formatter_->format(msg, formatted_);
+    print(msg.level, formatted_, msg.color_range_start, msg.color_range_end);
+}
+
+void ConsoleSink::logFormatted(const spdlog::details::log_msg& msg, const FormattedRecordPtr& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    print(msg.level, record->text, record->colorStart, record->colorEnd);
+}
+
+void ConsoleSink::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::fflush(file_);
+}
+
+void ConsoleSink::set_pattern(const std::string& pattern) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    formatter_ = std::make_unique<spdlog::pattern_formatter>(pattern);
+}
+
+void ConsoleSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    formatter_ = std::move(sink_formatter);
+}
+
+void ConsoleSink::print(spdlog::level::level_enum level, const spdlog::memory_buf_t& text, size_t colorStart,
+                        size_t colorEnd) {
+    if (!useColors_ || colorEnd <= colorStart || colorEnd > text.size()) {
+        std::fwrite(text.data(), 1, text.size(), file_);
+        return;
+    }
+    spdlog::string_view_t color = colors_[static_cast<size_t>(level)];
+    std::fwrite(text.data(), 1, colorStart, file_);
+    std::fwrite(color.data(), 1, color.size(), file_);
+    std::fwrite(text.data() + colorStart, 1, colorEnd - colorStart, file_);
+    std::fwrite(kReset.data(), 1, kReset.size(), file_);
+    std::fwrite(text.data() + colorEnd, 1, text.size() - colorEnd, file_);
+}
+
+} // namespace Logging
@@ -0,0 +1,35 @@
+#pragma once
+#include "formattedsink.h"
+#include <spdlog/formatter.h>
+#include <array>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+namespace Logging {
+
+// Colored stdout sink that can print records formatted by a FanoutSink. Colors the
+// %^...%$ range of the pattern by level, like spdlog's color sinks, when stdout is
+// a color terminal.
+class ConsoleSink : public FormattedSink {
+public:
+    ConsoleSink();
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void logFormatted(const spdlog::details::log_msg& msg, const FormattedRecordPtr& record) override;
+    void flush() override;
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+private:
+    void print(spdlog::level::level_enum level, const spdlog::memory_buf_t& text, size_t colorStart, size_t colorEnd);
+
+    std::FILE* file_;
+    bool useColors_;
+    std::array<spdlog::string_view_t, spdlog::level::n_levels> colors_;
+    std::mutex mutex_;
+    std::unique_ptr<spdlog::formatter> formatter_;
+    spdlog::memory_buf_t formatted_;
+};
+
+} // namespace Logging
@@ -0,0 +1,145 @@
+#include "crashring.h"
+#include "logclock.h"
+#include "mpscring.h"
+#include <spdlog/details/log_msg.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Logging {
+
+using namespace CrashRingFormat;
+
+namespace {
+
+constexpr size_t kMaxNameSize = 255;
+constexpr size_t kMaxFileSize = 255;
+constexpr size_t kMaxRecordSize = 64 * 1024;
+
+size_t alignUp(size_t size) {
+    return (size + kAlign - 1) & ~(kAlign - 1);
+}
+
+// True if path holds a ring, which may still have records to recover
+bool holdsRing(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    char magic[sizeof(kMagic)];
+    bool ring = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+                && std::memcmp(magic, kMagic, sizeof(magic)) == 0;
+    std::fclose(file);
+    return ring;
+}
+
+} // namespace
+
+CrashRingSink::CrashRingSink(const std::string& path, size_t capacity) {
+    capacity_ = roundUpToPowerOfTwo(std::max(capacity, kDataOffset));
+    maxRecord_ = std::min<size_t>(kMaxRecordSize, capacity_ / 4);
+    mapSize_ = kDataOffset + capacity_;
+
+    if (holdsRing(path) && std::rename(path.c_str(), (path + ".prev").c_str()) != 0) {
+        throw std::runtime_error("Cannot keep previous crash ring " + path + ": " + std::strerror(errno));
+    }
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot open crash ring " + path + ": " + std::strerror(errno));
+    }
+    if (::ftruncate(fd_, static_cast<off_t>(mapSize_)) != 0) {
+        std::string error = std::strerror(errno);
+        ::close(fd_);
+        throw std::runtime_error("Cannot size crash ring " + path + ": " + error);
+    }
+    // Populated up front, so logging never takes a page fault on the ring
+    void* map = ::mmap(nullptr, mapSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, 0);
+    if (map == MAP_FAILED) {
+        std::string error = std::strerror(errno);
+        ::close(fd_);
+        throw std::runtime_error("Cannot map crash ring " + path + ": " + error);
+    }
+    map_ = static_cast<char*>(map);
+    ring_ = map_ + kDataOffset;
+
+    // The file is new and zero-filled; the magic goes in last
+    header_ = reinterpret_cast<FileHeader*>(map_);
+    header_->version = kVersion;
+    header_->byteOrderMark = kByteOrderMark;
+    header_->capacity = capacity_;
+    header_->pid = static_cast<uint64_t>(::getpid());
+    header_->createdNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::system_clock::now().time_since_epoch()).count();
+    header_->head.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->magic, kMagic, sizeof(kMagic));
+    set_level(spdlog::level::trace);
+}
+
+CrashRingSink::~CrashRingSink() {
+    ::munmap(map_, mapSize_);
+    ::close(fd_);
+}
+
+void CrashRingSink::log(const spdlog::details::log_msg& msg) {
+    size_t nameSize = std::min(msg.logger_name.size(), kMaxNameSize);
+    const char* file = msg.source.empty() ? "" : msg.source.filename;
+    size_t fileSize = std::min(std::strlen(file), kMaxFileSize);
+    size_t fixedSize = sizeof(RecordHeader) + nameSize + fileSize;
+    size_t payloadSize = std::min(msg.payload.size(), maxRecord_ - fixedSize);
+    auto size = static_cast<uint32_t>(alignUp(fixedSize + payloadSize));
+
+    // Reserve the record, skipping to the start of the ring if it would not fit
+    uint64_t head = header_->head.load(std::memory_order_relaxed);
+    uint64_t start;
+    uint64_t end;
+    do {
+        uint64_t offset = head & (capacity_ - 1);
+        start = offset + size > capacity_ ? head + (capacity_ - offset) : head;
+        end = start + size;
+    } while (!header_->head.compare_exchange_weak(head, end, std::memory_order_relaxed));
+    if (start != head) {
+        writePadding(head, start);
+    }
+
+    char* at = ring_ + (start & (capacity_ - 1));
+    auto* record = reinterpret_cast<RecordHeader*>(at);
+    record->size = size;
+    record->type = static_cast<uint8_t>(RecordType::Record);
+    record->level = static_cast<uint8_t>(msg.level);
+    record->truncated = payloadSize < msg.payload.size() ? 1 : 0;
+    record->timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        LogClock::resolve(msg.time).time_since_epoch()).count();
+    record->threadId = msg.thread_id;
+    record->line = msg.source.empty() ? 0 : static_cast<uint32_t>(msg.source.line);
+    record->nameSize = static_cast<uint16_t>(nameSize);
+    record->fileSize = static_cast<uint16_t>(fileSize);
+    record->payloadSize = static_cast<uint32_t>(payloadSize);
+    char* text = at + sizeof(RecordHeader);
+    std::memcpy(text, msg.logger_name.data(), nameSize);
+    std::memcpy(text + nameSize, file, fileSize);
+    std::memcpy(text + nameSize + fileSize, msg.payload.data(), payloadSize);
+    record->end.store(end, std::memory_order_release);
+}
+
+void CrashRingSink::writePadding(uint64_t position, uint64_t end) {
+    // Too short for a header: the reader skips such a tail by itself
+    if (end - position < sizeof(RecordHeader)) {
+        return;
+    }
+    auto* padding = reinterpret_cast<RecordHeader*>(ring_ + (position & (capacity_ - 1)));
+    padding->size = static_cast<uint32_t>(end - position);
+    padding->type = static_cast<uint8_t>(RecordType::Padding);
+    padding->nameSize = 0;
+    padding->fileSize = 0;
+    padding->payloadSize = 0;
+    padding->end.store(end, std::memory_order_release);
+}
+
+} // namespace Logging
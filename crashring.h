@@ -0,0 +1,42 @@
+#pragma once
+#include "crashringformat.h"
+#include <spdlog/sinks/sink.h>
+#include <memory>
+#include <string>
+
+namespace Logging {
+
+// Writes every record, on the logging thread and before it is queued, into a
+// ring in a MAP_SHARED file: a CAS on the ring's head and a copy, no formatting
+// and no system call. When the process dies, the kernel still holds the pages,
+// so the last records survive even if they never left the async queue or a
+// stdio buffer; logix-recover extracts them. Put the file on tmpfs (/dev/shm)
+// to survive crashes of the process, on disk to survive a reboot after writeback.
+// The capacity is rounded up to a power of two. A ring found at path on start is
+// kept as path + ".prev".
+class CrashRingSink : public spdlog::sinks::sink {
+public:
+    CrashRingSink(const std::string& path, size_t capacity);
+    ~CrashRingSink() override;
+
+    CrashRingSink(const CrashRingSink&) = delete;
+    CrashRingSink& operator=(const CrashRingSink&) = delete;
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void flush() override {}
+    void set_pattern(const std::string&) override {}
+    void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+private:
+    void writePadding(uint64_t position, uint64_t end);
+
+    int fd_ = -1;
+    char* map_ = nullptr;
+    size_t mapSize_ = 0;
+    CrashRingFormat::FileHeader* header_ = nullptr;
+    char* ring_ = nullptr;
+    uint64_t capacity_ = 0;
+    size_t maxRecord_ = 0; // Longer messages are cut
+};
+
+} // namespace Logging
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Logging {
+
+// Layout of the crash ring file, shared by CrashRingSink and logix-recover.
+//
+// A FileHeader page is followed by capacity bytes of ring. Records are appended
+// to an endless byte stream whose position p lives at ring offset p % capacity;
+// head is the stream position reserved so far. A record never wraps: when it does
+// not fit before the end of the ring, the rest of the ring is skipped, marked by
+// a Padding record if a header fits there. Every record is a RecordHeader, the
+// logger name, the source file and the message, padded to kAlign bytes. Its end
+// field is stored last and commits it, so a reader trusts a record only when
+// end - size is the stream position of its offset and lies within the last
+// capacity bytes before head. Integers use the writer's native byte order,
+// checked through the mark.
+namespace CrashRingFormat {
+
+constexpr char kMagic[8] = {'L', 'O', 'G', 'I', 'X', 'R', 'N', 'G'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+constexpr size_t kDataOffset = 4096; // The ring starts on its own page
+constexpr size_t kAlign = 8;
+
+enum class RecordType : uint8_t { Record = 1, Padding = 2 };
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    uint64_t capacity; // Ring bytes after kDataOffset
+    uint64_t pid; // Process that writes the ring
+    int64_t createdNs; // Epoch ns the ring was created
+    alignas(64) std::atomic<uint64_t> head; // Stream bytes reserved so far
+};
+
+struct RecordHeader {
+    std::atomic<uint64_t> end; // Stream position just past this record; commits it
+    uint32_t size; // Whole record including padding
+    uint8_t type;
+    uint8_t level;
+    uint8_t truncated; // The message was cut to fit the ring
+    uint8_t reserved;
+    int64_t timeNs; // Epoch ns
+    uint64_t threadId;
+    uint32_t line;
+    uint16_t nameSize;
+    uint16_t fileSize;
+    uint32_t payloadSize;
+    uint32_t reserved2;
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "ring atomics must be plain 64-bit integers");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring atomics must be lock-free to work on shared memory");
+static_assert(sizeof(FileHeader) <= kDataOffset, "FileHeader must fit its page");
+static_assert(sizeof(RecordHeader) % kAlign == 0, "RecordHeader must keep records aligned");
+
+} // namespace CrashRingFormat
+} // namespace Logging
@@ -0,0 +1,133 @@
+#include "dedupsink.h"
+#include <spdlog/fmt/fmt.h>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string_view>
+
+namespace Logging {
+
+namespace {
+
+size_t recordHash(const spdlog::details::log_msg& msg) {
+    std::hash<std::string_view> hash;
+    size_t seed = hash(std::string_view(msg.logger_name.data(), msg.logger_name.size()));
+    seed ^= hash(std::string_view(msg.payload.data(), msg.payload.size())) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    return seed ^ static_cast<size_t>(msg.level);
+}
+
+bool sameView(spdlog::string_view_t a, const char* data, size_t size) {
+    return a.size() == size && std::memcmp(a.data(), data, size) == 0;
+}
+
+} // namespace
+
+DedupSink::DedupSink(spdlog::sink_ptr target, std::chrono::milliseconds window)
+    : target_(std::move(target)), formattedTarget_(std::dynamic_pointer_cast<FormattedSink>(target_)),
+      window_(window) {
+    // Level filtering happens on this decorator, the target sees everything it is given
+    target_->set_level(spdlog::level::trace);
+}
+
+DedupSink::~DedupSink() {
+    try {
+        reportRepeats();
+        target_->flush();
+    } catch (const std::exception&) {
+    }
+}
+
+void DedupSink::log(const spdlog::details::log_msg& msg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!repeat(msg)) {
+        target_->log(msg);
+    }
+}
+
+void DedupSink::logFormatted(const spdlog::details::log_msg& msg, const FormattedRecordPtr& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (repeat(msg)) {
+        return;
+    }
+    if (formattedTarget_) {
+        formattedTarget_->logFormatted(msg, record);
+    } else {
+        target_->log(msg);
+    }
+}
+
+void DedupSink::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Flushes come with every drain and priority record; only an expired burst ends here
+    if (spdlog::log_clock::now() - started_ >= window_) {
+        reportRepeats();
+    }
+    target_->flush();
+}
+
+// The earlier of the burst's end and the target's own deadline
+spdlog::log_clock::time_point DedupSink::deadline() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto deadline = repeats_ > 0 ? started_ + window_ : spdlog::log_clock::time_point::max();
+    if (formattedTarget_) {
+        deadline = std::min(deadline, formattedTarget_->deadline());
+    }
+    return deadline;
+}
+
+void DedupSink::expire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (spdlog::log_clock::now() - started_ >= window_) {
+        reportRepeats();
+    }
+    if (formattedTarget_) {
+        formattedTarget_->expire();
+    }
+}
+
+void DedupSink::set_pattern(const std::string& pattern) {
+    target_->set_pattern(pattern);
+}
+
+void DedupSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) {
+    target_->set_formatter(std::move(sink_formatter));
+}
+
+bool DedupSink::repeat(const spdlog::details::log_msg& msg) {
+    size_t hash = recordHash(msg);
+    if (active_ && hash == hash_ && msg.level == level_ && msg.time - started_ < window_
+        && sameView(msg.logger_name, name_.data(), name_.size())
+        && sameView(msg.payload, payload_.data(), payload_.size())) {
+        ++repeats_;
+        lastRepeat_ = msg.time;
+        lastThreadId_ = msg.thread_id;
+        return true;
+    }
+    reportRepeats();
+    active_ = true;
+    hash_ = hash;
+    name_.assign(msg.logger_name.data(), msg.logger_name.size());
+    level_ = msg.level;
+    payload_.clear();
+    payload_.append(msg.payload.data(), msg.payload.data() + msg.payload.size());
+    source_ = msg.source;
+    started_ = msg.time;
+    return false;
+}
+
+void DedupSink::reportRepeats() {
+    if (repeats_ == 0) {
+        return;
+    }
+    spdlog::memory_buf_t text;
+    text.append(payload_.data(), payload_.data() + payload_.size());
+    fmt::format_to(std::back_inserter(text), " (repeated {} times)", repeats_);
+    spdlog::details::log_msg summary(lastRepeat_, source_, name_, level_,
+                                     spdlog::string_view_t(text.data(), text.size()));
+    summary.thread_id = lastThreadId_;
+    repeats_ = 0;
+    target_->log(summary);
+}
+
+} // namespace Logging
@@ -0,0 +1,58 @@
+#pragma once
+#include "formattedsink.h"
+#include <spdlog/details/log_msg.h>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Logging {
+
+// Sink decorator collapsing bursts of identical records: the same logger name,
+// level and message in a row, within window of the burst's first record. The
+// first record passes at once; its repeats are counted and written as a single
+// "<message> (repeated N times)" record when the burst ends: at the next
+// different record, at a repeat arriving after the window, when the window
+// expires under an AsyncSink (its worker wakes up for the deadline), at the
+// first flush() after the window, or when the sink goes away. Records are
+// matched by hash first and compared in full only on a hit.
+class DedupSink : public FormattedSink {
+public:
+    DedupSink(spdlog::sink_ptr target, std::chrono::milliseconds window);
+    ~DedupSink() override;
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void logFormatted(const spdlog::details::log_msg& msg, const FormattedRecordPtr& record) override;
+    void flush() override;
+    spdlog::log_clock::time_point deadline() override;
+    void expire() override;
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+private:
+    // True if msg repeats the current burst; otherwise reports the burst and
+    // starts a new one with msg. Caller holds mutex_.
+    bool repeat(const spdlog::details::log_msg& msg);
+
+    // Write the repeat count of the current burst, if any. Caller holds mutex_.
+    void reportRepeats();
+
+    spdlog::sink_ptr target_;
+    std::shared_ptr<FormattedSink> formattedTarget_; // Set if target_ takes preformatted records
+    std::chrono::milliseconds window_;
+
+    std::mutex mutex_;
+    // The current burst: its first record and how often it has repeated since
+    bool active_ = false;
+    size_t hash_ = 0;
+    std::string name_;
+    spdlog::level::level_enum level_ = spdlog::level::trace;
+    spdlog::memory_buf_t payload_;
+    spdlog::source_loc source_;
+    spdlog::log_clock::time_point started_;
+    spdlog::log_clock::time_point lastRepeat_;
+    size_t lastThreadId_ = 0;
+    uint64_t repeats_ = 0;
+};
+
+} // namespace Logging
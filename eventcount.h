@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace Logging {
+
+// Lets a thread sleep until a lock-free condition may have changed, without
+// putting a lock on the notifying side. A waiter announces itself, re-checks its
+// condition and only then sleeps on a futex; a notifier pays one fence and a
+// load unless somebody is actually asleep.
+//
+//     auto key = event.prepareWait();
+//     if (conditionHolds()) { event.cancelWait(); } else { event.wait(key, timeout); }
+//
+// The notifier must publish its change before calling notify().
+class EventCount {
+public:
+    uint32_t prepareWait() {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return epoch_.load(std::memory_order_seq_cst);
+    }
+
+    void cancelWait() {
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void wait(uint32_t key, std::chrono::milliseconds timeout) {
+#ifdef __linux__
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+        ts.tv_nsec = static_cast<long>(timeout.count() % 1000) * 1000000L;
+        // Returns at once if the epoch moved since prepareWait()
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE, key, &ts, nullptr, 0);
+#else
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, timeout, [&] { return epoch_.load(std::memory_order_seq_cst) != key; });
+#endif
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void notifyOne() { notify(1); }
+    void notifyAll() { notify(INT_MAX); }
+
+private:
+    void notify(int count) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+#ifdef __linux__
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        if (count == 1) {
+            cv_.notify_one();
+        } else {
+            cv_.notify_all();
+        }
+#endif
+    }
+
+    std::atomic<uint32_t> epoch_{0};
+    std::atomic<uint32_t> waiters_{0};
+#ifndef __linux__
+    std::mutex mutex_;
+    std::condition_variable cv_;
+#endif
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+
+} // namespace Logging
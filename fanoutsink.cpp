@@ -0,0 +1,144 @@
+#include "fanoutsink.h"
+#include "logclock.h"
+#include <spdlog/pattern_formatter.h>
+#include <algorithm>
+#include <atomic>
+
+namespace Logging {
+
+namespace {
+
+// Rendered records a pattern keeps for reuse at least, enough when no sink queues them
+constexpr size_t kRecycledRecords = 1024;
+
+// Beyond the queues' capacity: records on their way into a queue, or held by a dedup stage
+constexpr size_t kSpareRecords = 16;
+
+// Records whose text grew beyond this are not kept, so one huge record does not pin its buffer
+constexpr size_t kRecycledCapacity = 16 * 1024;
+
+} // namespace
+
+FanoutSink::FanoutSink(size_t heldRecords)
+    : recycledRecords_(std::max(kRecycledRecords, heldRecords + kSpareRecords)) {}
+
+void FanoutSink::addSink(spdlog::sink_ptr sink, const std::string& pattern) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sink->set_pattern(pattern);
+    allSinks_.push_back(sink);
+
+    auto formattedSink = std::dynamic_pointer_cast<FormattedSink>(sink);
+    if (!formattedSink) {
+        rawSinks_.push_back(std::move(sink));
+        return;
+    }
+    for (auto& group : groups_) {
+        if (!group.pattern.empty() && group.pattern == pattern) {
+            group.sinks.push_back(std::move(formattedSink));
+            return;
+        }
+    }
+    Group group;
+    group.pattern = pattern;
+    group.formatter = std::make_unique<spdlog::pattern_formatter>(pattern);
+    group.sinks.push_back(std::move(formattedSink));
+    preallocate(group);
+    groups_.push_back(std::move(group));
+}
+
+void FanoutSink::log(const spdlog::details::log_msg& stamped) {
+    // Records of the LOGIX_* macros may still carry raw TSC ticks, the sinks see wall time
+    spdlog::details::log_msg msg = stamped;
+    msg.time = LogClock::resolve(stamped.time);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& group : groups_) {
+        FormattedRecordPtr record; // Rendered on first use, a group may filter everything out
+        for (auto& sink : group.sinks) {
+            if (sink->should_log(msg.level)) {
+                if (!record) {
+                    record = render(group, msg);
+                }
+                sink->logFormatted(msg, record);
+            }
+        }
+    }
+    for (auto& sink : rawSinks_) {
+        if (sink->should_log(msg.level)) {
+            sink->log(msg);
+        }
+    }
+}
+
+void FanoutSink::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& sink : allSinks_) {
+        sink->flush();
+    }
+}
+
+void FanoutSink::set_pattern(const std::string& pattern) {
+    mergeGroups(std::make_unique<spdlog::pattern_formatter>(pattern), pattern);
+}
+
+void FanoutSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) {
+    mergeGroups(std::move(sink_formatter), std::string());
+}
+
+FormattedRecordPtr FanoutSink::render(Group& group, const spdlog::details::log_msg& msg) {
+    std::shared_ptr<FormattedRecord>& slot = recycle(group);
+    FormattedRecord& record = *slot;
+    record.text.clear();
+    msg.color_range_start = 0;
+    msg.color_range_end = 0;
+    group.formatter->format(msg, record.text);
+    record.colorStart = msg.color_range_start;
+    record.colorEnd = msg.color_range_end;
+    return slot;
+}
+
+std::shared_ptr<FormattedRecord>& FanoutSink::recycle(Group& group) {
+    // Queued sinks release records in order, so the oldest is the first to come free
+    auto& oldest = group.records[group.next];
+    group.next = (group.next + 1) % group.records.size();
+    if (oldest.use_count() == 1) {
+        // use_count() is a relaxed load: the fence orders the last holder's reads of
+        // the text, released by its decrement, before the text is rewritten
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (oldest->text.capacity() > kRecycledCapacity) {
+            oldest = std::make_shared<FormattedRecord>();
+        }
+        return oldest;
+    }
+    // Oldest record still queued, more than the queues hold: replace it, the sink frees it
+    oldest = std::make_shared<FormattedRecord>();
+    return oldest;
+}
+
+void FanoutSink::preallocate(Group& group) {
+    // Allocated up front like the queues' slots, so a growing backlog allocates nothing
+    group.records.reserve(recycledRecords_);
+    while (group.records.size() < recycledRecords_) {
+        group.records.push_back(std::make_shared<FormattedRecord>());
+    }
+    group.next = 0;
+}
+
+void FanoutSink::mergeGroups(std::unique_ptr<spdlog::formatter> formatter, const std::string& pattern) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& sink : allSinks_) {
+        sink->set_formatter(formatter->clone());
+    }
+    Group merged;
+    merged.pattern = pattern;
+    merged.formatter = std::move(formatter);
+    for (auto& group : groups_) {
+        merged.sinks.insert(merged.sinks.end(), group.sinks.begin(), group.sinks.end());
+    }
+    groups_.clear();
+    if (!merged.sinks.empty()) {
+        preallocate(merged);
+        groups_.push_back(std::move(merged));
+    }
+}
+
+} // namespace Logging
@@ -0,0 +1,52 @@
+#pragma once
+#include "formattedsink.h"
+#include <spdlog/formatter.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Logging {
+
+// Dispatches records to several sinks, formatting each record once per distinct
+// pattern. FormattedSinks sharing a pattern all receive the same ref-counted
+// buffer; other sinks (different encodings) get the raw log_msg as usual.
+// Level filtering is done per child sink. Rendered records are recycled once the
+// sinks that queued them have let go, so formatting allocates nothing in steady state.
+class FanoutSink : public spdlog::sinks::sink {
+public:
+    // heldRecords: most records a child queue can hold at once; each pattern keeps
+    // that many rendered records, allocated up front, for reuse
+    explicit FanoutSink(size_t heldRecords = 0);
+
+    // Children must not be given their own pattern afterwards, set it here instead
+    void addSink(spdlog::sink_ptr sink, const std::string& pattern);
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void flush() override;
+    // Switches every child to one pattern, after which all share a single rendering
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+private:
+    struct Group {
+        std::string pattern; // Empty once a formatter was set directly
+        std::unique_ptr<spdlog::formatter> formatter;
+        std::vector<std::shared_ptr<FormattedSink>> sinks;
+        // Ring of rendered records, oldest at next; a record is reused once no sink holds it
+        std::vector<std::shared_ptr<FormattedRecord>> records;
+        size_t next = 0;
+    };
+
+    FormattedRecordPtr render(Group& group, const spdlog::details::log_msg& msg);
+    static std::shared_ptr<FormattedRecord>& recycle(Group& group);
+    void preallocate(Group& group);
+    void mergeGroups(std::unique_ptr<spdlog::formatter> formatter, const std::string& pattern);
+
+    const size_t recycledRecords_; // Ring size of every group
+    std::mutex mutex_;
+    std::vector<Group> groups_;
+    std::vector<spdlog::sink_ptr> rawSinks_;
+    std::vector<spdlog::sink_ptr> allSinks_;
+};
+
+} // namespace Logging
@@ -0,0 +1,213 @@
+#include "flightrecorder.h"
+#include "levelgate.h"
+#include "threadtuning.h"
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/os.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+namespace Logging {
+
+namespace {
+
+constexpr std::chrono::milliseconds kIdleWait{500};
+
+void onDumpSignal(int) {
+    FlightRecorder::instance().requestDump();
+}
+
+} // namespace
+
+FlightRecorder& FlightRecorder::instance() {
+    static FlightRecorder recorder;
+    return recorder;
+}
+
+FlightRecorder::~FlightRecorder() {
+    stop();
+}
+
+void FlightRecorder::start(const FlightRecorderOptions& options, spdlog::sink_ptr target, std::string loggerName) {
+    if (running_ || options.level == spdlog::level::off) {
+        return;
+    }
+    target_ = std::move(target);
+    loggerName_ = std::move(loggerName);
+    ringSize_.store(roundUpToPowerOfTwo(std::max<size_t>(options.ringSize, 2)));
+    // Decided once, so rings kept across restarts never mix stamp kinds
+    static const bool tsc = LogClock::tscReliable();
+    if (tsc) {
+        LogClock::calibrate();
+    }
+    tscStamps_.store(tsc);
+    stopRequested_.store(false);
+    dumpRequested_.store(false);
+    thread_ = std::thread([this]() { run(); });
+
+    struct sigaction action {};
+    action.sa_handler = onDumpSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, &previousAction_);
+
+    trigger_.store(options.trigger);
+    level_.store(options.level);
+    running_ = true;
+    LevelGate::invalidateAll();
+}
+
+void FlightRecorder::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    level_.store(spdlog::level::off);
+    trigger_.store(spdlog::level::off);
+    LevelGate::invalidateAll();
+    sigaction(SIGUSR1, &previousAction_, nullptr);
+
+    stopRequested_.store(true);
+    wakeup_.notifyOne();
+    thread_.join();
+    target_.reset();
+}
+
+uint32_t FlightRecorder::registerSite(spdlog::level::level_enum level, spdlog::string_view_t format,
+                                      const char* file, int line) {
+    std::lock_guard<std::mutex> lock(sitesMutex_);
+    sites_.push_back(Site{level, std::string(format.data(), format.size()), file, line});
+    return static_cast<uint32_t>(sites_.size() - 1);
+}
+
+void FlightRecorder::attachThread(ThreadState& local) {
+    // Hands the ring back for reuse when the thread exits. The thread state lets
+    // go of it first, as another thread may own the ring from then on.
+    struct Handle {
+        Ring* ring = nullptr;
+        ~Handle() {
+            threadState_.ring = nullptr;
+            threadState_.exited = true;
+            if (ring) {
+                ring->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+    static thread_local Handle handle;
+    if (!handle.ring) {
+        handle.ring = &acquireRing();
+    }
+    local.ring = handle.ring;
+    local.threadId = static_cast<uint32_t>(spdlog::details::os::thread_id());
+}
+
+FlightRecorder::Ring& FlightRecorder::acquireRing() {
+    size_t capacity = ringSize_.load();
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    for (auto& ring : rings_) {
+        // A retired ring keeps its records, which are dumped with the next
+        // thread's until they are overwritten
+        if (ring->retired.load(std::memory_order_acquire) && ring->mask + 1 == capacity) {
+            ring->retired.store(false, std::memory_order_relaxed);
+            return *ring;
+        }
+    }
+    rings_.push_back(std::make_unique<Ring>(capacity));
+    return *rings_.back();
+}
+
+void FlightRecorder::run() {
+    tuneCurrentThread("recorder");
+    for (;;) {
+        if (dumpRequested_.exchange(false)) {
+            try {
+                dump();
+            } catch (const std::exception& e) {
+                fprintf(stderr, "[*** LOG ERROR ***] [flight recorder] %s\n", e.what());
+            }
+        }
+        if (stopRequested_.load()) {
+            return;
+        }
+        uint32_t key = wakeup_.prepareWait();
+        if (dumpRequested_.load() || stopRequested_.load()) {
+            wakeup_.cancelWait();
+        } else {
+            wakeup_.wait(key, kIdleWait);
+        }
+    }
+}
+
+void FlightRecorder::dump() {
+    // Copy out every record not dumped before. A slot whose sequence word does
+    // not show its record complete before and after the copy was rewritten in
+    // between, or is being written, and is dropped.
+    std::vector<BinaryRecord> records;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        for (auto& ring : rings_) {
+            uint64_t capacity = ring->mask + 1;
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            uint64_t first = std::max(ring->dumped, head > capacity ? head - capacity : 0);
+            for (uint64_t i = first; i < head; ++i) {
+                Slot& slot = ring->slots[i & ring->mask];
+                uint64_t complete = 2 * i + 2;
+                if (slot.sequence.load(std::memory_order_acquire) != complete) {
+                    continue;
+                }
+                BinaryRecord rec;
+                std::memcpy(&rec, &slot.record, sizeof(BinaryRecord));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) == complete) {
+                    records.push_back(rec);
+                }
+            }
+            ring->dumped = head;
+        }
+    }
+    if (records.empty()) {
+        return;
+    }
+    std::stable_sort(records.begin(), records.end(),
+                     [](const BinaryRecord& a, const BinaryRecord& b) { return a.stamp < b.stamp; });
+    bool tsc = tscStamps_.load();
+    if (tsc) {
+        // The rate measured since start() converts the stamps
+        LogClock::calibrate();
+    }
+
+    std::vector<Site> sites;
+    {
+        std::lock_guard<std::mutex> lock(sitesMutex_);
+        sites = sites_;
+    }
+    auto now = spdlog::log_clock::now();
+    spdlog::memory_buf_t text;
+    fmt::format_to(std::back_inserter(text), "flight recorder: {} records", records.size());
+    target_->log(spdlog::details::log_msg(now, spdlog::source_loc{}, loggerName_, spdlog::level::info,
+                                          spdlog::string_view_t(text.data(), text.size())));
+    for (const BinaryRecord& rec : records) {
+        const Site& site = sites.at(rec.siteId);
+        text.clear();
+        BinaryFormat::formatMessage(site.format, rec.args, rec.argsSize, text);
+        if (rec.truncated) {
+            text.append(spdlog::string_view_t(" [truncated]"));
+        }
+        int64_t nanos = tsc ? LogClock::tscToEpochNanos(rec.stamp) : LogClock::toEpochNanos(rec.stamp);
+        spdlog::details::log_msg msg(spdlog::log_clock::time_point(std::chrono::duration_cast<spdlog::log_clock::duration>(
+                                         std::chrono::nanoseconds(nanos))),
+                                     spdlog::source_loc{site.file, site.line, ""},
+                                     loggerName_, site.level, spdlog::string_view_t(text.data(), text.size()));
+        msg.thread_id = rec.threadId;
+        target_->log(msg);
+    }
+    text.clear();
+    fmt::format_to(std::back_inserter(text), "flight recorder: end of {} records", records.size());
+    target_->log(spdlog::details::log_msg(now, spdlog::source_loc{}, loggerName_, spdlog::level::info,
+                                          spdlog::string_view_t(text.data(), text.size())));
+    target_->flush();
+}
+
+} // namespace Logging
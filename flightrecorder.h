@@ -0,0 +1,191 @@
+#pragma once
+#include "binarylog.h"
+#include "eventcount.h"
+#include "logclock.h"
+#include <spdlog/sinks/sink.h>
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Logging {
+
+struct FlightRecorderOptions {
+    spdlog::level::level_enum level = spdlog::level::off; // Lowest level captured, off disables
+    spdlog::level::level_enum trigger = spdlog::level::err; // Records at or above dump the rings
+    size_t ringSize = 256; // Records kept per thread
+};
+
+// Keeps the most recent records below the logger's level, from LOGIX_* call
+// sites, in a lock-free ring per thread: a site id, a timestamp and the raw
+// arguments in the binary log encoding, no formatting and no queue. A record at
+// the trigger level or SIGUSR1 has the recorder thread format the rings' content
+// and write it, oldest first, through the logger's sinks. Records are only
+// captured below the trigger level, so a dump never triggers another.
+//
+// Capture timestamps are raw TSC ticks wherever the TSC is reliable, whatever
+// LOG_CLOCK says, and are converted when the rings are dumped.
+class FlightRecorder {
+public:
+    static FlightRecorder& instance();
+
+    // Dumps go to target, the main logger's first sink, under loggerName
+    void start(const FlightRecorderOptions& options, spdlog::sink_ptr target, std::string loggerName);
+    void stop();
+
+    bool captures(spdlog::level::level_enum level) const {
+        return level >= level_.load(std::memory_order_relaxed) && level < trigger_.load(std::memory_order_relaxed);
+    }
+
+    // Wake the recorder thread to dump the rings. Async-signal-safe on Linux.
+    void requestDump() {
+        dumpRequested_.store(true, std::memory_order_relaxed);
+        wakeup_.notifyOne();
+    }
+
+    // Capture one record; site holds the call site's id + 1, 0 until registered.
+    // Formats that are not strings are not captured.
+    template <typename Format, typename... Args>
+    void record(std::atomic<uint32_t>& site, spdlog::level::level_enum level, const char* file, int line,
+                const Format& format, const Args&... args) {
+        if constexpr (std::is_convertible<const Format&, spdlog::string_view_t>::value) {
+            uint32_t id = site.load(std::memory_order_relaxed);
+            if (id == 0) {
+                // Threads racing here register the site twice, which is harmless
+                id = registerSite(level, spdlog::string_view_t(format), file, line) + 1;
+                site.store(id, std::memory_order_relaxed);
+            }
+            ThreadState& local = threadState_;
+            if (!local.ring) {
+                // A thread logging from its thread_local destructors has handed its ring back
+                if (local.exited) {
+                    return;
+                }
+                attachThread(local);
+            }
+            Ring& ring = *local.ring;
+            uint64_t head = ring.head.load(std::memory_order_relaxed);
+            Slot& slot = ring.slots[head & ring.mask];
+            // Odd while the slot is being written, so a dump copying it can tell
+            slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            BinaryRecord& rec = slot.record;
+            rec.siteId = id - 1;
+            rec.threadId = local.threadId;
+            rec.stamp = stamp();
+            BinaryFormat::ArgWriter writer(rec.args, sizeof(rec.args));
+            (void)std::initializer_list<int>{(encode(writer, args), 0)...};
+            rec.argsSize = static_cast<uint16_t>(writer.size());
+            rec.truncated = writer.truncated() ? 1 : 0;
+            slot.sequence.store(2 * head + 2, std::memory_order_release);
+            ring.head.store(head + 1, std::memory_order_release);
+        }
+    }
+
+private:
+    struct Site {
+        spdlog::level::level_enum level;
+        std::string format;
+        const char* file;
+        int line;
+    };
+
+    // A record and the sequence word guarding it: 2 * index + 2 once the record
+    // with that ring index is complete, odd while it is being written
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        BinaryRecord record;
+    };
+
+    // Written by its thread only; the recorder thread reads it concurrently and
+    // drops slots that were rewritten while it copied them
+    struct Ring {
+        explicit Ring(size_t capacity) : slots(new Slot[capacity]), mask(capacity - 1) {}
+
+        std::unique_ptr<Slot[]> slots;
+        const uint64_t mask;
+        std::atomic<uint64_t> head{0}; // Records written so far
+        std::atomic<bool> retired{false}; // Owner thread has exited, the ring may be reused
+        uint64_t dumped = 0; // Records up to here were dumped already; recorder side
+    };
+
+    // The calling thread's ring and id, looked up on its first capture only.
+    // Trivial, so the thread_local is zero-initialized without a TLS guard, and
+    // never destroyed: exited stays readable after the ring is handed back.
+    struct ThreadState {
+        Ring* ring;
+        uint32_t threadId;
+        bool exited; // Ring handed back at thread exit, nothing more is captured
+    };
+
+    FlightRecorder() = default;
+    ~FlightRecorder();
+
+    template <typename T>
+    static void encode(BinaryFormat::ArgWriter& writer, const T& value) {
+        if constexpr (std::is_arithmetic<T>::value || std::is_enum<T>::value) {
+            writer.write(value);
+        } else if constexpr (std::is_convertible<const T&, spdlog::string_view_t>::value) {
+            writer.write(spdlog::string_view_t(value));
+        } else {
+            // Anything else fmt can print is rendered up front, into the slot
+            writer.writeFormatted(value);
+        }
+    }
+
+    static int64_t stamp() {
+        return tscStamps_.load(std::memory_order_relaxed) ? LogClock::readTsc() : LogClock::stamp();
+    }
+
+    uint32_t registerSite(spdlog::level::level_enum level, spdlog::string_view_t format, const char* file, int line);
+    void attachThread(ThreadState& local);
+    Ring& acquireRing();
+    void run();
+    void dump();
+
+    static inline thread_local ThreadState threadState_;
+    static inline std::atomic<bool> tscStamps_{false};
+
+    std::atomic<int> level_{spdlog::level::off};
+    std::atomic<int> trigger_{spdlog::level::off};
+    std::atomic<size_t> ringSize_{256};
+
+    std::mutex sitesMutex_;
+    std::vector<Site> sites_;
+
+    std::mutex ringsMutex_;
+    std::vector<std::unique_ptr<Ring>> rings_; // Kept for the whole process, reused once retired
+
+    spdlog::sink_ptr target_;
+    std::string loggerName_;
+    std::atomic<bool> dumpRequested_{false};
+    std::atomic<bool> stopRequested_{false};
+    EventCount wakeup_;
+    std::thread thread_;
+    struct sigaction previousAction_ {};
+    bool running_ = false;
+};
+
+// Placed among the fanout's sinks: records at or above its level have the
+// flight recorder dump its rings
+class FlightTriggerSink : public spdlog::sinks::sink {
+public:
+    explicit FlightTriggerSink(spdlog::level::level_enum trigger) {
+        set_level(trigger);
+    }
+
+    void log(const spdlog::details::log_msg&) override {
+        FlightRecorder::instance().requestDump();
+    }
+    void flush() override {}
+    void set_pattern(const std::string&) override {}
+    void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+};
+
+} // namespace Logging
@@ -0,0 +1,125 @@
+#include "flushpolicy.h"
+#include "threadtuning.h"
+#include <spdlog/pattern_formatter.h>
+#include <unistd.h>
+#include <cstdio>
+
+namespace Logging {
+
+spdlog::file_event_handlers FileSyncHandle::handlers() const {
+    spdlog::file_event_handlers handlers;
+    auto fd = fd_;
+    handlers.after_open = [fd](const spdlog::filename_t&, std::FILE* file) {
+        fd->store(::fileno(file), std::memory_order_release);
+    };
+    handlers.before_close = [fd](const spdlog::filename_t&, std::FILE*) {
+        fd->store(-1, std::memory_order_release);
+    };
+    return handlers;
+}
+
+void FileSyncHandle::sync() const {
+    int fd = fd_->load(std::memory_order_acquire);
+    if (fd >= 0) {
+#ifdef __APPLE__
+        ::fsync(fd);
+#else
+        ::fdatasync(fd);
+#endif
+    }
+}
+
+GroupCommitSink::GroupCommitSink(spdlog::sink_ptr target, FlushPolicy policy, std::function<bool()> queueDrained,
+                                 std::function<void()> syncHook)
+    : target_(std::move(target)), formattedTarget_(std::dynamic_pointer_cast<FormattedSink>(target_)),
+      policy_(policy), queueDrained_(std::move(queueDrained)), syncHook_(std::move(syncHook)),
+      formatter_(std::make_unique<spdlog::pattern_formatter>()) {
+    // Level filtering happens on this decorator, the target sees everything it is given
+    target_->set_level(spdlog::level::trace);
+}
+
+void GroupCommitSink::log(const spdlog::details::log_msg& msg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    target_->log(msg);
+    formatted_.clear();
+    formatter_->format(msg, formatted_);
+    recordWritten(msg, formatted_.size());
+}
+
+void GroupCommitSink::logFormatted(const spdlog::details::log_msg& msg, const FormattedRecordPtr& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (formattedTarget_) {
+        formattedTarget_->logFormatted(msg, record);
+    } else {
+        target_->log(msg);
+    }
+    recordWritten(msg, record->text.size());
+}
+
+void GroupCommitSink::recordWritten(const spdlog::details::log_msg& msg, size_t bytes) {
+    if (pendingRecords_ == 0) {
+        oldestPending_ = msg.time;
+    }
+    ++pendingRecords_;
+    pendingBytes_ += bytes;
+
+    bool due = msg.level >= policy_.level
+            || (policy_.bytes > 0 && pendingBytes_ >= policy_.bytes)
+            || (policy_.interval.count() > 0 && msg.time - oldestPending_ >= policy_.interval)
+            || (policy_.onDrain && (!queueDrained_ || queueDrained_()));
+    if (due) {
+        commit();
+    }
+}
+
+void GroupCommitSink::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    commit();
+}
+
+void GroupCommitSink::set_pattern(const std::string& pattern) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    formatter_ = std::make_unique<spdlog::pattern_formatter>(pattern);
+    target_->set_pattern(pattern);
+}
+
+void GroupCommitSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    formatter_ = sink_formatter->clone();
+    target_->set_formatter(std::move(sink_formatter));
+}
+
+void GroupCommitSink::commit() {
+    if (pendingRecords_ == 0) {
+        return;
+    }
+    target_->flush();
+    if (policy_.sync && syncHook_) {
+        syncHook_();
+    }
+    pendingRecords_ = 0;
+    pendingBytes_ = 0;
+}
+
+PeriodicFlusher::PeriodicFlusher(std::function<void()> callback, std::chrono::milliseconds interval) {
+    thread_ = std::thread([this, callback = std::move(callback), interval]() {
+        tuneCurrentThread("flusher");
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!cv_.wait_for(lock, interval, [this] { return stop_; })) {
+            lock.unlock();
+            callback();
+            lock.lock();
+        }
+    });
+}
+
+PeriodicFlusher::~PeriodicFlusher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+} // namespace Logging
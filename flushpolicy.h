@@ -0,0 +1,87 @@
+#pragma once
+#include "formattedsink.h"
+#include <spdlog/formatter.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Logging {
+
+// When buffered sink output is pushed to the OS (and optionally to disk)
+struct FlushPolicy {
+    spdlog::level::level_enum level = spdlog::level::err; // Flush at or above this level, off disables
+    std::chrono::milliseconds interval{0}; // Flush when the oldest unflushed record is this old, 0 disables
+    size_t bytes = 0;     // Flush once this many formatted bytes are unflushed, 0 disables
+    bool onDrain = true;  // Flush whenever the async queue runs empty
+    bool sync = false;    // fdatasync() file sinks after every flush
+};
+
+// Tracks the descriptor of a spdlog file sink across rotations so it can be fdatasync()ed
+class FileSyncHandle {
+public:
+    FileSyncHandle() : fd_(std::make_shared<std::atomic<int>>(-1)) {}
+
+    // Pass to the file sink constructor
+    spdlog::file_event_handlers handlers() const;
+
+    void sync() const;
+
+private:
+    std::shared_ptr<std::atomic<int>> fd_;
+};
+
+// Sink decorator implementing group commit: records are written to the target
+// right away, but the target is only flushed when the policy says so. Explicit
+// flush() calls, e.g. from logger->flush(), always commit pending output.
+// Preformatted records are passed on when the target accepts them. The byte
+// threshold counts formatted output; log() formats records for that as well.
+class GroupCommitSink : public FormattedSink {
+public:
+    GroupCommitSink(spdlog::sink_ptr target, FlushPolicy policy, std::function<bool()> queueDrained,
+                    std::function<void()> syncHook = {});
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void logFormatted(const spdlog::details::log_msg& msg, const FormattedRecordPtr& record) override;
+    void flush() override;
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+private:
+    void recordWritten(const spdlog::details::log_msg& msg, size_t bytes);
+    void commit();
+
+    spdlog::sink_ptr target_;
+    std::shared_ptr<FormattedSink> formattedTarget_; // Set if target_ takes preformatted records
+    FlushPolicy policy_;
+    std::function<bool()> queueDrained_;
+    std::function<void()> syncHook_;
+
+    std::mutex mutex_;
+    std::unique_ptr<spdlog::formatter> formatter_; // Sizes records given to log()
+    spdlog::memory_buf_t formatted_;
+    size_t pendingBytes_ = 0;
+    size_t pendingRecords_ = 0;
+    spdlog::log_clock::time_point oldestPending_;
+};
+
+// Calls a function at a fixed interval on its own thread, used to flush idle loggers
+class PeriodicFlusher {
+public:
+    PeriodicFlusher(std::function<void()> callback, std::chrono::milliseconds interval);
+    ~PeriodicFlusher();
+
+    PeriodicFlusher(const PeriodicFlusher&) = delete;
+    PeriodicFlusher& operator=(const PeriodicFlusher&) = delete;
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+} // namespace Logging
@@ -0,0 +1,30 @@
+#pragma once
+#include <spdlog/sinks/sink.h>
+#include <memory>
+
+namespace Logging {
+
+// A record rendered once and shared, read-only, by every sink using the same pattern
+struct FormattedRecord {
+    spdlog::memory_buf_t text;
+    size_t colorStart = 0; // Range of the pattern's color markers (%^...%$) in text
+    size_t colorEnd = 0;
+};
+
+using FormattedRecordPtr = std::shared_ptr<const FormattedRecord>;
+
+// Sink that can take records already formatted by a FanoutSink instead of running
+// its own formatter. log() keeps working for standalone use.
+class FormattedSink : public spdlog::sinks::sink {
+public:
+    // record was produced with the pattern the sink was registered under; it may be
+    // kept past the call
+    virtual void logFormatted(const spdlog::details::log_msg& msg, const FormattedRecordPtr& record) = 0;
+
+    // When the sink wants expire() called even if no record comes, max() if never.
+    // A queue running the sink calls it from its worker while idle.
+    virtual spdlog::log_clock::time_point deadline() { return spdlog::log_clock::time_point::max(); }
+    virtual void expire() {}
+};
+
+} // namespace Logging
@@ -0,0 +1,87 @@
+#include "jsonwriter.h"
+#include <iterator>
+
+namespace Logging {
+
+namespace {
+
+bool needsEscape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+void appendEscaped(spdlog::memory_buf_t& out, unsigned char c) {
+    static const char hex[] = "0123456789abcdef";
+    switch (c) {
+    case '"': out.append(spdlog::string_view_t("\\\"")); break;
+    case '\\': out.append(spdlog::string_view_t("\\\\")); break;
+    case '\b': out.append(spdlog::string_view_t("\\b")); break;
+    case '\f': out.append(spdlog::string_view_t("\\f")); break;
+    case '\n': out.append(spdlog::string_view_t("\\n")); break;
+    case '\r': out.append(spdlog::string_view_t("\\r")); break;
+    case '\t': out.append(spdlog::string_view_t("\\t")); break;
+    default: {
+        char unicode[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0f]};
+        out.append(unicode, unicode + sizeof(unicode));
+        break;
+    }
+    }
+}
+
+} // namespace
+
+void JsonWriter::appendString(spdlog::memory_buf_t& out, spdlog::string_view_t value) {
+    out.push_back('"');
+    const char* data = value.data();
+    size_t runStart = 0;
+    // Copy unescaped runs in one go, escapes are rare in log text
+    for (size_t i = 0; i < value.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (needsEscape(c)) {
+            out.append(data + runStart, data + i);
+            appendEscaped(out, c);
+            runStart = i + 1;
+        }
+    }
+    out.append(data + runStart, data + value.size());
+    out.push_back('"');
+}
+
+void JsonWriter::beginObject() {
+    out_.push_back('{');
+    first_ = true;
+}
+
+void JsonWriter::endObject() {
+    out_.push_back('}');
+}
+
+void JsonWriter::key(spdlog::string_view_t key) {
+    if (!first_) {
+        out_.push_back(',');
+    }
+    first_ = false;
+    appendString(out_, key);
+    out_.push_back(':');
+}
+
+void JsonWriter::field(spdlog::string_view_t key, spdlog::string_view_t value) {
+    this->key(key);
+    appendString(out_, value);
+}
+
+void JsonWriter::numberField(spdlog::string_view_t key, int64_t value) {
+    this->key(key);
+    fmt::format_to(std::back_inserter(out_), "{}", value);
+}
+
+void JsonWriter::numberField(spdlog::string_view_t key, uint64_t value) {
+    this->key(key);
+    fmt::format_to(std::back_inserter(out_), "{}", value);
+}
+
+void JsonWriter::boolField(spdlog::string_view_t key, bool value) {
+    this->key(key);
+    out_.append(value ? spdlog::string_view_t("true") : spdlog::string_view_t("false"));
+}
+
+} // namespace Logging
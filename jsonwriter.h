@@ -0,0 +1,35 @@
+#pragma once
+#include <spdlog/common.h>
+#include <cstdint>
+
+namespace Logging {
+
+// Streaming JSON writer that appends straight into a caller-owned buffer.
+// It keeps no DOM and never allocates beyond the buffer's own growth, so a
+// reused buffer makes encoding a record allocation-free. Escaping matches
+// nlohmann::json::dump(); bytes >= 0x80 are passed through unchanged.
+class JsonWriter {
+public:
+    explicit JsonWriter(spdlog::memory_buf_t& out) : out_(out) {}
+
+    void beginObject();
+    void endObject();
+
+    // Key/value pairs; the writer inserts the separating commas.
+    // Numbers and booleans have their own names so string literals never convert to bool.
+    void field(spdlog::string_view_t key, spdlog::string_view_t value);
+    void numberField(spdlog::string_view_t key, int64_t value);
+    void numberField(spdlog::string_view_t key, uint64_t value);
+    void boolField(spdlog::string_view_t key, bool value);
+
+    // Append a quoted, escaped JSON string
+    static void appendString(spdlog::memory_buf_t& out, spdlog::string_view_t value);
+
+private:
+    void key(spdlog::string_view_t key);
+
+    spdlog::memory_buf_t& out_;
+    bool first_ = true;
+};
+
+} // namespace Logging
@@ -0,0 +1,22 @@
+#include "levelgate.h"
+#include "flightrecorder.h"
+#include "loggerfacade.h"
+
+namespace Logging {
+
+LevelGate::Decision LevelGate::refresh(uint64_t generation) {
+    // Pairs with invalidateAll(): the logger and level read below are at least as
+    // new as the generation the decision is tagged with
+    std::atomic_thread_fence(std::memory_order_acquire);
+    spdlog::logger* logger = LoggerFacade::getInstance().activeLogger();
+    Decision decision = Skip;
+    if (logger && logger->should_log(level_)) {
+        decision = Log;
+    } else if (FlightRecorder::instance().captures(level_)) {
+        decision = Record;
+    }
+    state_.store(generation << 2 | decision, std::memory_order_relaxed);
+    return decision;
+}
+
+} // namespace Logging
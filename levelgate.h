@@ -0,0 +1,51 @@
+#pragma once
+#include <spdlog/common.h>
+#include <atomic>
+#include <cstdint>
+
+namespace Logging {
+
+// Cached level decision of one logging call site. The decision is tagged with the
+// generation it was made in; LoggerFacade bumps the global generation whenever
+// the level or the logger changes, and a site that sees a newer generation asks
+// the logger again. While nothing changes, a disabled statement costs a relaxed
+// load of the generation, a load of the site's own state and one branch.
+class LevelGate {
+public:
+    enum Decision : uint64_t {
+        Skip = 0,
+        Log = 1,
+        Record = 2, // Below the logger's level, kept by the flight recorder
+    };
+
+    explicit constexpr LevelGate(spdlog::level::level_enum level) : level_(level) {}
+
+    Decision decide() {
+        uint64_t generation = generation_.load(std::memory_order_relaxed);
+        uint64_t state = state_.load(std::memory_order_relaxed);
+        if (state >> 2 == generation) {
+            return static_cast<Decision>(state & 3);
+        }
+        return refresh(generation);
+    }
+
+    bool enabled() {
+        return decide() == Log;
+    }
+
+    // Make every call site decide again on its next call
+    static void invalidateAll() {
+        generation_.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+private:
+    Decision refresh(uint64_t generation);
+
+    // Starts at 1 so that a site's zero state never counts as current
+    static inline std::atomic<uint64_t> generation_{1};
+
+    const spdlog::level::level_enum level_;
+    std::atomic<uint64_t> state_{0}; // Generation << 2 | decision
+};
+
+} // namespace Logging
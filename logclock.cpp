@@ -0,0 +1,179 @@
+#include "logclock.h"
+#include "threadtuning.h"
+#include <cmath>
+#include <fstream>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace Logging {
+
+namespace {
+
+// Time the first calibration measures over before the TSC is used
+constexpr std::chrono::milliseconds kInitialCalibration{10};
+
+// A TSC reading taken together with CLOCK_REALTIME
+struct ClockSample {
+    int64_t ticks = 0;
+    int64_t nanos = 0;
+};
+
+// Conversion parameters, published by the calibrating thread through a seqlock
+struct Calibration {
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<int64_t> baseTicks{0};
+    std::atomic<int64_t> baseNanos{0};
+    std::atomic<double> nanosPerTick{0.0};
+};
+
+Calibration calibration;
+std::mutex calibrationMutex;
+bool anchored = false;
+ClockSample anchor; // First sample; the rate is measured over everything since
+
+ClockSample sampleClocks() {
+    // Keep the reading whose TSC window around clock_gettime was narrowest
+    ClockSample best;
+    int64_t bestWindow = INT64_MAX;
+    for (int attempt = 0; attempt < 5; ++attempt) {
+        int64_t before = LogClock::readTsc();
+        int64_t nanos = LogClock::realtimeNanos();
+        int64_t after = LogClock::readTsc();
+        if (after - before < bestWindow) {
+            bestWindow = after - before;
+            best.ticks = before + (after - before) / 2;
+            best.nanos = nanos;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+bool clockSourceFromString(const std::string& name, ClockSource& source) {
+    if (name == "realtime") {
+        source = ClockSource::Realtime;
+    } else if (name == "coarse") {
+        source = ClockSource::Coarse;
+    } else if (name == "tsc") {
+        source = ClockSource::Tsc;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* clockSourceName(ClockSource source) {
+    switch (source) {
+    case ClockSource::Coarse:
+        return "coarse";
+    case ClockSource::Tsc:
+        return "tsc";
+    default:
+        return "realtime";
+    }
+}
+
+bool LogClock::tscReliable() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    // Invariant TSC: constant rate across P-, C- and T-states
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8))) {
+        return false;
+    }
+    // The kernel drops the TSC as its clocksource when it sees it drift between cores
+    std::ifstream current("/sys/devices/system/clocksource/clocksource0/current_clocksource");
+    std::string name;
+    if (current >> name && name != "tsc") {
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+ClockSource LogClock::select(ClockSource requested) {
+    if (requested == ClockSource::Tsc) {
+        if (!tscReliable()) {
+            requested = ClockSource::Coarse;
+        } else {
+            {
+                std::lock_guard<std::mutex> lock(calibrationMutex);
+                anchor = sampleClocks();
+                anchored = true;
+            }
+            std::this_thread::sleep_for(kInitialCalibration);
+            calibrate();
+        }
+    }
+    source_.store(requested, std::memory_order_relaxed);
+    return requested;
+}
+
+void LogClock::calibrate() {
+    std::lock_guard<std::mutex> lock(calibrationMutex);
+    ClockSample now = sampleClocks();
+    if (!anchored || now.ticks <= anchor.ticks) {
+        anchor = now;
+        anchored = true;
+        return;
+    }
+    double rate = static_cast<double>(now.nanos - anchor.nanos) / static_cast<double>(now.ticks - anchor.ticks);
+
+    uint32_t sequence = calibration.sequence.load(std::memory_order_relaxed);
+    calibration.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    calibration.baseTicks.store(now.ticks, std::memory_order_relaxed);
+    calibration.baseNanos.store(now.nanos, std::memory_order_relaxed);
+    calibration.nanosPerTick.store(rate, std::memory_order_relaxed);
+    calibration.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+int64_t LogClock::toEpochNanos(int64_t stamp) {
+    return source() == ClockSource::Tsc ? tscToEpochNanos(stamp) : stamp;
+}
+
+int64_t LogClock::tscToEpochNanos(int64_t ticks) {
+    int64_t baseTicks;
+    int64_t baseNanos;
+    double rate;
+    for (;;) {
+        uint32_t sequence = calibration.sequence.load(std::memory_order_acquire);
+        baseTicks = calibration.baseTicks.load(std::memory_order_relaxed);
+        baseNanos = calibration.baseNanos.load(std::memory_order_relaxed);
+        rate = calibration.nanosPerTick.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!(sequence & 1) && calibration.sequence.load(std::memory_order_relaxed) == sequence) {
+            break;
+        }
+    }
+    return baseNanos + std::llround(static_cast<double>(ticks - baseTicks) * rate);
+}
+
+TscCalibrator::TscCalibrator(std::chrono::milliseconds interval) {
+    thread_ = std::thread([this, interval]() {
+        tuneCurrentThread("clock");
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!cv_.wait_for(lock, interval, [this] { return stop_; })) {
+            lock.unlock();
+            LogClock::calibrate();
+            lock.lock();
+        }
+    });
+}
+
+TscCalibrator::~TscCalibrator() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+} // namespace Logging
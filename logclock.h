@@ -0,0 +1,140 @@
+#pragma once
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace Logging {
+
+// Where hot paths take their record times from
+enum class ClockSource {
+    Realtime, // clock_gettime(CLOCK_REALTIME) through the vDSO, what spdlog uses
+    Coarse,   // CLOCK_REALTIME_COARSE: a plain memory read, resolution of a scheduler tick
+    Tsc       // Invariant TSC read with rdtsc, turned into wall time on the worker
+};
+
+// Parse "realtime", "coarse" or "tsc"; returns false for anything else
+bool clockSourceFromString(const std::string& name, ClockSource& source);
+
+const char* clockSourceName(ClockSource source);
+
+// Record clock of the hot paths. stamp() returns a raw value that is only
+// meaningful to toEpochNanos(): TSC ticks in Tsc mode, epoch nanoseconds
+// otherwise. Producers store the stamp and the worker converts it, so the
+// logging thread never pays for the conversion. The TSC is calibrated against
+// CLOCK_REALTIME by TscCalibrator, which also follows NTP adjustments.
+class LogClock {
+public:
+    // Switch the source; Tsc falls back to Coarse where the TSC is not invariant
+    // or the kernel does not trust it. Returns the source in effect. Must not be
+    // called while stamps taken under the previous source are still queued.
+    static ClockSource select(ClockSource requested);
+
+    static ClockSource source() { return source_.load(std::memory_order_relaxed); }
+
+    // True if this machine has a TSC good enough for timestamps
+    static bool tscReliable();
+
+    static int64_t stamp() {
+        switch (source_.load(std::memory_order_relaxed)) {
+        case ClockSource::Tsc:
+            return readTsc();
+        case ClockSource::Coarse:
+            return coarseNanos();
+        default:
+            return realtimeNanos();
+        }
+    }
+
+    static int64_t toEpochNanos(int64_t stamp);
+
+    // Record time of the LOGIX_* macros. In Tsc mode the time point carries the
+    // raw ticks as a negative count, which no real wall time has, until the worker
+    // passes it through resolve(). Realtime reads the clock spdlog itself uses.
+    static spdlog::log_clock::time_point now() {
+        switch (source_.load(std::memory_order_relaxed)) {
+        case ClockSource::Tsc:
+            return spdlog::log_clock::time_point(spdlog::log_clock::duration(~readTsc()));
+        case ClockSource::Coarse:
+            return spdlog::log_clock::time_point(std::chrono::duration_cast<spdlog::log_clock::duration>(
+                std::chrono::nanoseconds(coarseNanos())));
+        default:
+            return spdlog::details::os::now();
+        }
+    }
+
+    // Wall time of a time point taken by now(); other time points pass unchanged
+    static spdlog::log_clock::time_point resolve(spdlog::log_clock::time_point time) {
+        auto count = time.time_since_epoch().count();
+        if (count >= 0) {
+            return time;
+        }
+        return spdlog::log_clock::time_point(std::chrono::duration_cast<spdlog::log_clock::duration>(
+            std::chrono::nanoseconds(tscToEpochNanos(~count))));
+    }
+
+    static spdlog::log_clock::time_point toTimePoint(int64_t stamp) {
+        return spdlog::log_clock::time_point(
+            std::chrono::duration_cast<spdlog::log_clock::duration>(std::chrono::nanoseconds(toEpochNanos(stamp))));
+    }
+
+    // Measure the TSC rate against CLOCK_REALTIME since the first calibration
+    // and move the conversion base to now
+    static void calibrate();
+
+    // Epoch nanoseconds of a TSC reading, whatever the current source
+    static int64_t tscToEpochNanos(int64_t ticks);
+
+    static int64_t readTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+        return static_cast<int64_t>(__rdtsc());
+#else
+        return 0;
+#endif
+    }
+
+    static int64_t realtimeNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    static int64_t coarseNanos() {
+#ifdef CLOCK_REALTIME_COARSE
+        timespec ts;
+        ::clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+        return realtimeNanos();
+#endif
+    }
+
+private:
+    static inline std::atomic<ClockSource> source_{ClockSource::Realtime};
+};
+
+// Recalibrates the TSC once per interval while it exists. Only needed in Tsc mode.
+class TscCalibrator {
+public:
+    explicit TscCalibrator(std::chrono::milliseconds interval);
+    ~TscCalibrator();
+
+    TscCalibrator(const TscCalibrator&) = delete;
+    TscCalibrator& operator=(const TscCalibrator&) = delete;
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+} // namespace Logging
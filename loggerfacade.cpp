@@ -1,105 +1,108 @@
 #include "loggerfacade.h"
 #include <spdlog/async.h>
-#include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/null_sink.h>
-#include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/pattern_formatter.h>
-#include <QUdpSocket>
-#include <QHostAddress>
-#include <QString>
+#include "asyncpipeline.h"
+#include "asyncsink.h"
+#include "binarylog.h"
+#include "consolesink.h"
+#include "dedupsink.h"
+#include "fanoutsink.h"
+#include "flushpolicy.h"
+#include "logclock.h"
+#include "rotatingfilesink.h"
+#include "spscstaging.h"
+#include "udpsink.h"
+#include <algorithm>
 #include <cstdlib>
 #include <stdexcept>
 #include <filesystem>
 #include <fstream>
-#include <nlohmann/json.hpp>
 #include <sstream>
-#include <iomanip>
-#include <ctime>
+#include <chrono>
 
 namespace Logging {
 
-// Custom UDP sink for network logging with JSON or plain text support
-class UdpSink : public spdlog::sinks::sink {
-public:
-    UdpSink(const std::string& host, uint16_t port, const std::string& pattern, const std::string& udp_format)
-        : host_(host), port_(port), udp_format_(udp_format) {
-        if (host_.empty() || port_ == 0) {
-            throw std::invalid_argument("Invalid UDP sink configuration: host or port is empty");
-        }
-        // Set formatter with provided pattern
-        formatter_ = std::make_unique<spdlog::pattern_formatter>(pattern);
-    }
-
-    void log(const spdlog::details::log_msg& msg) override {
-        // Format the message
-        spdlog::memory_buf_t formatted;
-        formatter_->format(msg, formatted);
-        std::string plain_msg = fmt::to_string(formatted);
-
-        // Create socket in the worker thread if not already created
-        if (!socket_) {
-            socket_ = std::make_unique<QUdpSocket>();
-        }
-
-        // Send as JSON or plain text based on udp_format_
-        if (udp_format_ == "json") {
-            // Calculate time components without fmt
-            auto dur = msg.time.time_since_epoch();
-            auto secs = std::chrono::duration_cast<std::chrono::seconds>(dur);
-            auto tp_whole_sec = std::chrono::system_clock::time_point(secs);
-            auto t = std::chrono::system_clock::to_time_t(tp_whole_sec);
-            std::tm bt = *std::localtime(&t);  // Use localtime to match fmt's default behavior for chrono
-            std::ostringstream ss;
-            ss << std::put_time(&bt, "%Y-%m-%d %H:%M:%S");
-            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(dur - secs).count();
-            ss << '.' << std::setfill('0') << std::setw(3) << ms;
-            std::string time_str = ss.str();
-
-            // Convert to JSON
-            nlohmann::json json_msg = {
-                {"time", time_str},
-                {"level", spdlog::level::to_string_view(msg.level).data()},
-                {"logger", msg.logger_name.data()},
-                {"message", plain_msg}
-            };
-            std::string json_str = json_msg.dump();
+namespace {
 
-            // Send JSON message over UDP
-            QString qHost = QString::fromStdString(host_);
-            socket_->writeDatagram(json_str.c_str(), json_str.size(), QHostAddress(qHost), port_);
-        } else {
-            // Send plain text message over UDP
-            QString qHost = QString::fromStdString(host_);
-            socket_->writeDatagram(plain_msg.c_str(), plain_msg.size(), QHostAddress(qHost), port_);
+// How often the TSC rate is measured again, which also follows NTP adjustments
+constexpr std::chrono::seconds kClockCalibrationInterval{1};
+
+// Read a positive integer from the environment, keeping the default on bad input
+size_t readPositiveEnv(const char* name, size_t defaultValue) {
+    const char* valueStr = std::getenv(name);
+    if (!valueStr) {
+        return defaultValue;
+    }
+    try {
+        long long value = std::stoll(valueStr);
+        if (value > 0) {
+            return static_cast<size_t>(value);
         }
+        spdlog::warn("{} must be a positive number. Using default {}.", name, defaultValue);
+    } catch (const std::exception&) {
+        spdlog::warn("Invalid {} value: {}. Using default {}.", name, valueStr, defaultValue);
     }
+    return defaultValue;
+}
 
-    void flush() override {}
-
-    void set_pattern(const std::string& pattern) override {
-        formatter_ = std::make_unique<spdlog::pattern_formatter>(pattern);
+// Read an on/off switch from the environment
+bool readFlagEnv(const char* name, bool defaultValue) {
+    const char* valueStr = std::getenv(name);
+    if (!valueStr) {
+        return defaultValue;
+    }
+    std::string value = valueStr;
+    if (value == "1" || value == "true" || value == "on" || value == "yes") {
+        return true;
     }
+    if (value == "0" || value == "false" || value == "off" || value == "no") {
+        return false;
+    }
+    spdlog::warn("Invalid {} value: {}. Using default ({}).", name, valueStr, defaultValue ? "on" : "off");
+    return defaultValue;
+}
 
-    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override {
-        formatter_ = std::move(sink_formatter);
+// Read a sink queue overflow policy from the environment
+std::string readOverflowEnv(const char* name, const std::string& defaultValue) {
+    const char* valueStr = std::getenv(name);
+    if (!valueStr) {
+        return defaultValue;
     }
+    std::string value = valueStr;
+    if (value == "block" || value == "drop") {
+        return value;
+    }
+    spdlog::warn("Invalid {} value: {}. Using default ({}).", name, valueStr, defaultValue);
+    return defaultValue;
+}
 
-    void set_level(spdlog::level::level_enum level) {
-        level_ = level;
+// The sink's own queue, or null when sinks share the logger's worker. It holds at
+// most LOG_QUEUE_BYTES of payloads and rendered text. latency is only given for
+// the sink whose priority records count as on disk.
+std::shared_ptr<AsyncSink> makeSinkQueue(const LoggerConfig& config, const std::shared_ptr<PayloadPool>& pool,
+                                         const char* name, size_t size,
+                                         const std::string& overflow,
+                                         std::shared_ptr<PriorityLatency> latency = nullptr) {
+    if (!config.sinkQueues) {
+        return nullptr;
     }
+    auto policy = overflow == "drop" ? SinkOverflow::DiscardNew : SinkOverflow::Block;
+    auto queue = std::make_shared<AsyncSink>(name, size > 0 ? size : config.sinkQueueSize, policy, pool,
+                                             config.queueBytes);
+    queue->setPriority(spdlog::level::from_str(config.priorityLevel), config.prioritySync, std::move(latency));
+    return queue;
+}
 
-    spdlog::level::level_enum level() const {
-        return level_;
+// sink behind a stage collapsing bursts of identical records, if a window is set
+spdlog::sink_ptr withDedup(spdlog::sink_ptr sink, size_t windowMs) {
+    if (windowMs == 0) {
+        return sink;
     }
+    return std::make_shared<DedupSink>(std::move(sink), std::chrono::milliseconds(windowMs));
+}
 
-private:
-    std::string host_;
-    uint16_t port_;
-    std::string udp_format_; // "json" or "plain"
-    std::unique_ptr<QUdpSocket> socket_; // Initialized lazily in log()
-    spdlog::level::level_enum level_ = spdlog::level::trace;
-    std::unique_ptr<spdlog::formatter> formatter_;
-};
+} // namespace
 
 // Load configuration from environment variables
 LoggerConfig LoggerConfig::loadFromEnv() {
@@ -126,6 +129,11 @@ LoggerConfig LoggerConfig::loadFromEnv() {
         config.filePath = filePathStr;
     }
 
+    const char* binaryPathStr = std::getenv("LOG_BINARY_PATH");
+    if (binaryPathStr) {
+        config.binaryPath = binaryPathStr;
+    }
+
     const char* ipStr = std::getenv("LOG_NETWORK_IP");
     if (ipStr) {
         config.networkIp = ipStr;
@@ -145,19 +153,11 @@ LoggerConfig LoggerConfig::loadFromEnv() {
         }
     }
 
-    const char* numberOfLogFilesStr = std::getenv("LOG_NIMBER_OF_LOG_FILES");
-    if (numberOfLogFilesStr) {
-        try {
-            int size = std::stoi(numberOfLogFilesStr);
-            if (size > 0) {
-                config.numberOfLogFiles = static_cast<size_t>(size);
-            } else {
-                spdlog::warn("LOG_NIMBER_OF_LOG_FILES number of log files. Using default {}.", config.numberOfLogFiles);
-            }
-        } catch (const std::exception& e) {
-            spdlog::warn("Invalid LOG_NIMBER_OF_LOG_FILES value: {}. Using default {}.", numberOfLogFilesStr, config.numberOfLogFiles);
-        }
-    }
+    // LOG_NUMBER_OF_LOGS is the documented name; the misspelled original still works
+    config.numberOfLogFiles = readPositiveEnv("LOG_NIMBER_OF_LOG_FILES", config.numberOfLogFiles);
+    config.numberOfLogFiles = readPositiveEnv("LOG_NUMBER_OF_LOGS", config.numberOfLogFiles);
+    config.fileTotalMb = readPositiveEnv("LOG_FILE_TOTAL_MB", config.fileTotalMb);
+    config.fileCompress = readFlagEnv("LOG_FILE_COMPRESS", config.fileCompress);
 
     const char* portStr = std::getenv("LOG_NETWORK_PORT");
     if (portStr) {
@@ -172,6 +172,24 @@ LoggerConfig LoggerConfig::loadFromEnv() {
     if (levelStr) {
         config.logLevel = levelStr;
     }
+    const char* moduleLevelsStr = std::getenv("LOG_LEVELS");
+    if (moduleLevelsStr) {
+        std::stringstream entries(moduleLevelsStr);
+        std::string entry;
+        while (std::getline(entries, entry, ',')) {
+            if (entry.empty()) {
+                continue;
+            }
+            size_t equals = entry.find('=');
+            std::string name = entry.substr(0, equals);
+            std::string level = equals == std::string::npos ? "" : entry.substr(equals + 1);
+            if (name.empty() || (level != "off" && spdlog::level::from_str(level) == spdlog::level::off)) {
+                spdlog::warn("Invalid LOG_LEVELS entry: {}. Ignoring it.", entry);
+                continue;
+            }
+            config.moduleLevels.emplace_back(name, spdlog::level::from_str(level));
+        }
+    }
 
     const char* patternStr = std::getenv("LOG_PATTERN");
     if (patternStr) {
@@ -188,6 +206,170 @@ LoggerConfig LoggerConfig::loadFromEnv() {
         }
     }
 
+    const char* queueEngineStr = std::getenv("LOG_QUEUE_ENGINE");
+    if (queueEngineStr) {
+        config.queueEngine = queueEngineStr;
+        if (config.queueEngine != "spdlog" && config.queueEngine != "mpsc" && config.queueEngine != "spsc") {
+            spdlog::warn("Invalid LOG_QUEUE_ENGINE value: {}. Using default (spdlog).", queueEngineStr);
+            config.queueEngine = "spdlog";
+        }
+    }
+    config.queueSize = readPositiveEnv("LOG_QUEUE_SIZE", config.queueSize);
+    config.threadQueueSize = readPositiveEnv("LOG_THREAD_QUEUE_SIZE", config.threadQueueSize);
+    config.queueBytes = readPositiveEnv("LOG_QUEUE_BYTES", config.queueBytes);
+    config.payloadPoolBytes = readPositiveEnv("LOG_PAYLOAD_POOL_BYTES", config.payloadPoolBytes);
+
+    const char* flushLevelStr = std::getenv("LOG_FLUSH_LEVEL");
+    if (flushLevelStr) {
+        std::string flushLevel = flushLevelStr;
+        if (flushLevel == "off" || spdlog::level::from_str(flushLevel) != spdlog::level::off) {
+            config.flushLevel = flushLevel;
+        } else {
+            spdlog::warn("Invalid LOG_FLUSH_LEVEL value: {}. Using default ({}).", flushLevelStr, config.flushLevel);
+        }
+    }
+    config.flushIntervalMs = readPositiveEnv("LOG_FLUSH_INTERVAL_MS", config.flushIntervalMs);
+    config.flushBytes = readPositiveEnv("LOG_FLUSH_BYTES", config.flushBytes);
+    config.flushOnDrain = readFlagEnv("LOG_FLUSH_ON_DRAIN", config.flushOnDrain);
+    config.flushSync = readFlagEnv("LOG_FLUSH_SYNC", config.flushSync);
+
+    const char* udpTimeFormatStr = std::getenv("LOG_UDP_TIME_FORMAT");
+    if (udpTimeFormatStr) {
+        TimestampFormat format;
+        if (timestampFormatFromString(udpTimeFormatStr, format)) {
+            config.udpTimeFormat = udpTimeFormatStr;
+        } else {
+            spdlog::warn("Invalid LOG_UDP_TIME_FORMAT value: {}. Using default (local).", udpTimeFormatStr);
+        }
+    }
+
+    const char* clockStr = std::getenv("LOG_CLOCK");
+    if (clockStr) {
+        ClockSource source;
+        if (clockSourceFromString(clockStr, source)) {
+            config.clockSource = clockStr;
+        } else {
+            spdlog::warn("Invalid LOG_CLOCK value: {}. Using default (realtime).", clockStr);
+        }
+    }
+
+    const char* udpTransportStr = std::getenv("LOG_UDP_TRANSPORT");
+    if (udpTransportStr) {
+        config.udpTransport = udpTransportStr;
+        if (config.udpTransport != "posix" && config.udpTransport != "qt") {
+            spdlog::warn("Invalid LOG_UDP_TRANSPORT value: {}. Using default (posix).", udpTransportStr);
+            config.udpTransport = "posix";
+        }
+    }
+    config.udpSendBufferBytes = readPositiveEnv("LOG_UDP_SNDBUF", config.udpSendBufferBytes);
+
+    config.udpBatching = readFlagEnv("LOG_UDP_BATCH", config.udpBatching);
+    config.udpMtu = readPositiveEnv("LOG_UDP_MTU", config.udpMtu);
+    config.udpBatchLingerMs = readPositiveEnv("LOG_UDP_BATCH_LINGER_MS", config.udpBatchLingerMs);
+
+    const char* overflowLevelStr = std::getenv("LOG_OVERFLOW_BLOCK_LEVEL");
+    if (overflowLevelStr) {
+        std::string overflowLevel = overflowLevelStr;
+        if (overflowLevel == "off" || spdlog::level::from_str(overflowLevel) != spdlog::level::off) {
+            config.overflowBlockLevel = overflowLevel;
+        } else {
+            spdlog::warn("Invalid LOG_OVERFLOW_BLOCK_LEVEL value: {}. Using default ({}).", overflowLevelStr,
+                         config.overflowBlockLevel);
+        }
+    }
+    const char* priorityLevelStr = std::getenv("LOG_PRIORITY_LEVEL");
+    if (priorityLevelStr) {
+        std::string priorityLevel = priorityLevelStr;
+        if (priorityLevel == "off" || spdlog::level::from_str(priorityLevel) != spdlog::level::off) {
+            config.priorityLevel = priorityLevel;
+        } else {
+            spdlog::warn("Invalid LOG_PRIORITY_LEVEL value: {}. Using default ({}).", priorityLevelStr,
+                         config.priorityLevel);
+        }
+    }
+    config.prioritySync = readFlagEnv("LOG_PRIORITY_SYNC", config.prioritySync);
+
+    config.overflowReservePercent = readPositiveEnv("LOG_OVERFLOW_RESERVE_PERCENT", config.overflowReservePercent);
+    config.dropSummaryMs = readPositiveEnv("LOG_DROP_SUMMARY_MS", config.dropSummaryMs);
+
+    config.sinkQueues = readFlagEnv("LOG_SINK_QUEUES", config.sinkQueues);
+    config.workers = readPositiveEnv("LOG_WORKERS", config.workers);
+
+    if (config.workers > 1 && !config.sinkQueues) {
+        // Without their own queues the sinks would be driven by several workers at once
+        spdlog::warn("LOG_WORKERS requires LOG_SINK_QUEUES. Using a single worker.");
+        config.workers = 1;
+    }
+
+    const char* cpusStr = std::getenv("LOG_WORKER_CPUS");
+    if (cpusStr && !parseCpuList(cpusStr, config.threadTuning.cpus)) {
+        spdlog::warn("Invalid LOG_WORKER_CPUS value: {}. Leaving CPU affinity unchanged.", cpusStr);
+    }
+    const char* niceStr = std::getenv("LOG_WORKER_NICE");
+    if (niceStr) {
+        try {
+            int nice = std::stoi(niceStr);
+            if (nice >= -20 && nice <= 19) {
+                config.threadTuning.setNice = true;
+                config.threadTuning.nice = nice;
+            } else {
+                spdlog::warn("LOG_WORKER_NICE must be between -20 and 19. Leaving the nice value unchanged.");
+            }
+        } catch (const std::exception&) {
+            spdlog::warn("Invalid LOG_WORKER_NICE value: {}. Leaving the nice value unchanged.", niceStr);
+        }
+    }
+    const char* schedStr = std::getenv("LOG_WORKER_SCHED");
+    if (schedStr) {
+        std::string sched = schedStr;
+        if (sched == "idle" || sched == "other") {
+            config.threadTuning.idle = sched == "idle";
+        } else {
+            spdlog::warn("Invalid LOG_WORKER_SCHED value: {}. Using default (other).", schedStr);
+        }
+    }
+    const char* threadNameStr = std::getenv("LOG_THREAD_NAME");
+    if (threadNameStr) {
+        config.threadTuning.namePrefix = threadNameStr;
+    }
+    config.sinkQueueSize = readPositiveEnv("LOG_SINK_QUEUE_SIZE", config.sinkQueueSize);
+    config.consoleQueueSize = readPositiveEnv("LOG_CONSOLE_QUEUE_SIZE", config.consoleQueueSize);
+    config.fileQueueSize = readPositiveEnv("LOG_FILE_QUEUE_SIZE", config.fileQueueSize);
+    config.networkQueueSize = readPositiveEnv("LOG_NETWORK_QUEUE_SIZE", config.networkQueueSize);
+    config.consoleOverflow = readOverflowEnv("LOG_CONSOLE_OVERFLOW", config.consoleOverflow);
+    config.fileOverflow = readOverflowEnv("LOG_FILE_OVERFLOW", config.fileOverflow);
+    config.networkOverflow = readOverflowEnv("LOG_NETWORK_OVERFLOW", config.networkOverflow);
+    config.consoleDedupMs = readPositiveEnv("LOG_CONSOLE_DEDUP_MS", config.consoleDedupMs);
+    config.fileDedupMs = readPositiveEnv("LOG_FILE_DEDUP_MS", config.fileDedupMs);
+    config.networkDedupMs = readPositiveEnv("LOG_NETWORK_DEDUP_MS", config.networkDedupMs);
+
+    const char* recorderLevelStr = std::getenv("LOG_FLIGHT_RECORDER");
+    if (recorderLevelStr) {
+        std::string recorderLevel = recorderLevelStr;
+        if (recorderLevel == "off" || spdlog::level::from_str(recorderLevel) != spdlog::level::off) {
+            config.flightRecorderLevel = recorderLevel;
+        } else {
+            spdlog::warn("Invalid LOG_FLIGHT_RECORDER value: {}. Using default (off).", recorderLevelStr);
+        }
+    }
+    config.flightRecorderSize = readPositiveEnv("LOG_FLIGHT_RECORDER_SIZE", config.flightRecorderSize);
+    const char* recorderTriggerStr = std::getenv("LOG_FLIGHT_RECORDER_TRIGGER");
+    if (recorderTriggerStr) {
+        std::string recorderTrigger = recorderTriggerStr;
+        if (recorderTrigger == "off" || spdlog::level::from_str(recorderTrigger) != spdlog::level::off) {
+            config.flightRecorderTrigger = recorderTrigger;
+        } else {
+            spdlog::warn("Invalid LOG_FLIGHT_RECORDER_TRIGGER value: {}. Using default ({}).", recorderTriggerStr,
+                         config.flightRecorderTrigger);
+        }
+    }
+
+    const char* crashRingPathStr = std::getenv("LOG_CRASH_RING_PATH");
+    if (crashRingPathStr) {
+        config.crashRingPath = crashRingPathStr;
+    }
+    config.crashRingMb = readPositiveEnv("LOG_CRASH_RING_MB", config.crashRingMb);
+
     return config;
 }
 
@@ -197,6 +379,68 @@ LoggerFacade& LoggerFacade::getInstance() {
     return instance;
 }
 
+LoggerFacade::LoggerFacade() = default;
+LoggerFacade::~LoggerFacade() = default;
+
+std::function<bool()> LoggerFacade::queueDrainedProbe() const {
+    if (pipeline_) {
+        std::weak_ptr<AsyncPipeline> weakPipeline = pipeline_;
+        return [weakPipeline]() {
+            auto pipeline = weakPipeline.lock();
+            return !pipeline || pipeline->drained();
+        };
+    }
+    auto queued = threadPoolQueueSize();
+    return [queued]() {
+        return queued() == 0;
+    };
+}
+
+std::function<size_t()> LoggerFacade::threadPoolQueueSize() const {
+    std::vector<std::weak_ptr<spdlog::details::thread_pool>> pools(threadPools_.begin(), threadPools_.end());
+    return [pools]() {
+        size_t total = 0;
+        for (const auto& pool : pools) {
+            if (auto tp = pool.lock()) {
+                total += tp->queue_size();
+            }
+        }
+        return total;
+    };
+}
+
+void LoggerFacade::addSink(spdlog::sink_ptr sink, const std::shared_ptr<AsyncSink>& queue) {
+    if (queue) {
+        queue->start(std::move(sink));
+        sink = queue;
+    }
+    // Levels are applied by the loggers, before a record is queued; a sink level
+    // would also filter records already on their way when the level changes
+    sink->set_level(spdlog::level::trace);
+    sinks_.push_back(std::move(sink));
+}
+
+spdlog::level::level_enum LoggerFacade::effectiveLevel(const std::string& name) const {
+    std::string module = name;
+    for (;;) {
+        auto it = moduleLevels_.find(module);
+        if (it != moduleLevels_.end()) {
+            return it->second;
+        }
+        size_t dot = module.rfind('.');
+        if (dot == std::string::npos) {
+            return logger_->level();
+        }
+        module.resize(dot);
+    }
+}
+
+void LoggerFacade::applyModuleLevels() {
+    for (auto& named : namedLoggers_) {
+        named.second->set_level(effectiveLevel(named.first));
+    }
+}
+
 void LoggerFacade::initialize() {
     if (isInitialized_) {
         spdlog::warn("Logger already initialized. Skipping re-initialization.");
@@ -204,14 +448,66 @@ void LoggerFacade::initialize() {
     }
 
     try {
-        // Initialize thread pool explicitly
-        spdlog::init_thread_pool(8192, 1); // 8192 queue size, 1 thread
         LoggerConfig config = LoggerConfig::loadFromEnv();
         sinks_.clear();
+        {
+            std::lock_guard<std::mutex> lock(loggersMutex_);
+            moduleLevels_.clear();
+            moduleLevels_.insert(config.moduleLevels.begin(), config.moduleLevels.end());
+        }
+        priorityLatency_ = std::make_shared<PriorityLatency>();
+        setThreadTuning(config.threadTuning); // Before any background thread starts
+
+        ClockSource requestedClock = ClockSource::Realtime;
+        clockSourceFromString(config.clockSource, requestedClock);
+        if (LogClock::select(requestedClock) != requestedClock) {
+            spdlog::warn("TSC is not invariant or not trusted by the kernel. Using the coarse clock.");
+        }
+        if (LogClock::source() == ClockSource::Tsc) {
+            calibrator_ = std::make_unique<TscCalibrator>(kClockCalibrationInterval);
+        }
+
+        // Set up the queue engine before the sinks, which probe it for drain boundaries.
+        // Its slots are preallocated; the budget bounds the payloads they point to, and
+        // those that do not fit inline in a slot go to the pool shared with the sink queues.
+        queueBudget_ = std::make_shared<QueueBudget>(config.queueBytes, config.overflowReservePercent);
+        payloadPool_ = std::make_shared<PayloadPool>(config.payloadPoolBytes);
+        // Each worker gets its own queue; a single spdlog pool with several threads would reorder records
+        size_t workerQueueSize = std::max<size_t>(config.queueSize / config.workers, 2);
+        if (config.queueEngine == "mpsc" || config.queueEngine == "spsc") {
+            std::vector<std::unique_ptr<RecordQueue>> queues;
+            for (size_t i = 0; i < config.workers; ++i) {
+                if (config.queueEngine == "mpsc") {
+                    queues.push_back(std::make_unique<MpscRecordQueue>(workerQueueSize, payloadPool_));
+                } else {
+                    queues.push_back(std::make_unique<SpscRecordQueue>(config.threadQueueSize, payloadPool_));
+                }
+            }
+            pipeline_ = std::make_shared<AsyncPipeline>(std::move(queues), queueBudget_);
+        } else {
+            // Initialize thread pool explicitly, 1 thread each
+            auto tuneWorker = [](size_t i) {
+                return [i]() { tuneCurrentThread("worker" + std::to_string(i)); };
+            };
+            spdlog::init_thread_pool(workerQueueSize, 1, tuneWorker(0));
+            threadPools_.push_back(spdlog::thread_pool());
+            for (size_t i = 1; i < config.workers; ++i) {
+                threadPools_.push_back(
+                    std::make_shared<spdlog::details::thread_pool>(workerQueueSize, 1, tuneWorker(i)));
+            }
+        }
 
         // Convert string log level to enum
         spdlog::level::level_enum logLevel = spdlog::level::from_str(config.logLevel);
 
+        // Group commit replaces flushing after every record
+        FlushPolicy flushPolicy;
+        flushPolicy.level = spdlog::level::from_str(config.flushLevel);
+        flushPolicy.interval = std::chrono::milliseconds(config.flushIntervalMs);
+        flushPolicy.bytes = config.flushBytes;
+        flushPolicy.onDrain = config.flushOnDrain;
+        flushPolicy.sync = config.flushSync;
+
         // Check if "none" is the only mode
         if (config.logModes.size() == 1 && config.logModes[0] == "none") {
             // Null sink for disabled logging
@@ -223,10 +519,13 @@ void LoggerFacade::initialize() {
             spdlog::info("Logger initialized. Mode: none");
         } else {
             // Console sink (always included for visibility)
-            auto consoleSink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-            consoleSink->set_level(logLevel);
-            consoleSink->set_pattern(config.logPattern);
-            sinks_.push_back(consoleSink);
+            // Each sink gets its own queue, so a slow terminal or network only holds up the file
+            // once its queue is full, or never if that queue drops
+            auto consoleQueue = makeSinkQueue(config, payloadPool_, "console", config.consoleQueueSize, config.consoleOverflow);
+            auto consoleSink = std::make_shared<ConsoleSink>();
+            auto consoleCommit = std::make_shared<GroupCommitSink>(
+                consoleSink, flushPolicy, consoleQueue ? consoleQueue->drainedProbe() : queueDrainedProbe());
+            addSink(withDedup(consoleCommit, config.consoleDedupMs), consoleQueue);
 
             // Process each mode
             for (const auto& mode : config.logModes) {
@@ -251,44 +550,189 @@ void LoggerFacade::initialize() {
                             testFile << "Test write to file" << std::endl;
                             testFile.close();
 
-                            // Use rotating file sink
-                            auto fileSink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
-                                config.filePath, 1024 * 1024 * config.fileSizeMb, 3); // 5MB, 3 files
-                            fileSink->set_level(logLevel);
-                            fileSink->set_pattern(config.logPattern);
+                            // Rotate with a single rename, archives are compressed and pruned in the background
+                            RotationOptions rotation;
+                            rotation.maxFileSize = 1024 * 1024 * config.fileSizeMb;
+                            rotation.maxFiles = config.numberOfLogFiles;
+                            rotation.maxTotalBytes = 1024 * 1024 * config.fileTotalMb;
+                            rotation.compress = config.fileCompress;
+                            FileSyncHandle syncHandle;
+                            auto fileSink = std::make_shared<RotatingFileSink>(config.filePath, rotation, syncHandle.handlers());
+                            fileSink->set_pattern(config.logPattern); // For the test record below
                             fileSink->log(spdlog::details::log_msg("", spdlog::level::info, "Initial test log to file"));
                             fileSink->flush();
-                            sinks_.push_back(fileSink);
+                            auto fileQueue = makeSinkQueue(config, payloadPool_, "file", config.fileQueueSize, config.fileOverflow,
+                                                           priorityLatency_);
+                            auto fileCommit = std::make_shared<GroupCommitSink>(
+                                fileSink, flushPolicy, fileQueue ? fileQueue->drainedProbe() : queueDrainedProbe(),
+                                [syncHandle]() { syncHandle.sync(); });
+                            addSink(withDedup(fileCommit, config.fileDedupMs), fileQueue);
                         } catch (const std::exception& e) {
                             spdlog::error("Failed to initialize file sink for '{}': {}", config.filePath, e.what());
                         }
                     }
+                } else if (mode == "binary") {
+                    if (config.binaryPath.empty()) {
+                        spdlog::warn("LOG_BINARY_PATH not set for binary mode. Skipping binary log.");
+                    } else {
+                        try {
+                            // Deferred formatting: LOGIX_BIN_* call sites bypass the sinks entirely
+                            BinaryLogger::instance().start(config.binaryPath, config.queueSize, logLevel);
+                        } catch (const std::exception& e) {
+                            spdlog::error("Failed to initialize binary log '{}': {}", config.binaryPath, e.what());
+                        }
+                    }
                 } else if (mode == "network") {
                     if (config.networkIp.empty() || config.networkPort == 0) {
                         spdlog::warn("Invalid network configuration (IP or port missing). Skipping network sink.");
                     } else {
                         try {
-                            auto udpSink = std::make_shared<UdpSink>(config.networkIp, config.networkPort, config.logPattern, config.udpFormat);
-                            udpSink->set_level(logLevel);
-                            sinks_.push_back(udpSink);
-                        } catch (const std::invalid_argument& e) {
+                            auto networkQueue = makeSinkQueue(config, payloadPool_, "network", config.networkQueueSize,
+                                                              config.networkOverflow);
+                            UdpBatchOptions batch;
+                            batch.enabled = config.udpBatching;
+                            batch.mtu = config.udpMtu;
+                            batch.linger = std::chrono::milliseconds(config.udpBatchLingerMs);
+                            // Send at the end of each drain of the async queue
+                            batch.queueDrained = networkQueue ? networkQueue->drainedProbe() : queueDrainedProbe();
+                            // Resolve the destination once, here rather than per message
+                            auto transport = makeUdpTransport(config.udpTransport, config.networkIp, config.networkPort,
+                                                              config.udpSendBufferBytes);
+                            TimestampFormat timeFormat = TimestampFormat::Local;
+                            timestampFormatFromString(config.udpTimeFormat, timeFormat);
+                            auto udpSink = std::make_shared<UdpSink>(std::move(transport), config.logPattern,
+                                                                     config.udpFormat, timeFormat, std::move(batch));
+                            addSink(withDedup(udpSink, config.networkDedupMs), networkQueue);
+                        } catch (const std::exception& e) {
                             spdlog::error("Failed to initialize UDP sink: {}", e.what());
                         }
                     }
                 }
             }
 
+            // Format each record once per pattern on the worker and share it among the sinks.
+            // Every worker formats with its own fanout and feeds the same sink queues.
+            FlightRecorderOptions recorder;
+            recorder.level = spdlog::level::from_str(config.flightRecorderLevel);
+            recorder.trigger = spdlog::level::from_str(config.flightRecorderTrigger);
+            recorder.ringSize = config.flightRecorderSize;
+            // Rendered records stay alive while queued: keep enough to reuse them all
+            size_t heldRecords = 0;
+            for (const auto& sink : sinks_) {
+                if (auto queue = std::dynamic_pointer_cast<AsyncSink>(sink)) {
+                    heldRecords = std::max(heldRecords, queue->capacity());
+                }
+            }
+            std::vector<std::shared_ptr<FanoutSink>> fanoutSinks;
+            for (size_t i = 0; i < config.workers; ++i) {
+                auto fanout = std::make_shared<FanoutSink>(heldRecords);
+                for (const auto& sink : sinks_) {
+                    fanout->addSink(sink, config.logPattern);
+                }
+                if (recorder.level != spdlog::level::off && recorder.trigger != spdlog::level::off) {
+                    fanout->addSink(std::make_shared<FlightTriggerSink>(recorder.trigger), config.logPattern);
+                }
+                fanoutSinks.push_back(std::move(fanout));
+            }
+            const auto& fanoutSink = fanoutSinks.front();
+
+            // Records at the priority level skip the async queue; per-sink queues serve them first
+            std::shared_ptr<PriorityLane> priorityLane;
+            spdlog::level::level_enum priorityLevel = spdlog::level::from_str(config.priorityLevel);
+            if (priorityLevel != spdlog::level::off) {
+                priorityLane = std::make_shared<PriorityLane>(
+                    priorityLevel, fanoutSink, config.prioritySync && !config.sinkQueues,
+                    config.sinkQueues ? nullptr : priorityLatency_);
+            }
+
+            // A full queue drops records below the block level instead of stalling producers
+            LevelOverflowOptions overflow;
+            overflow.blockLevel = spdlog::level::from_str(config.overflowBlockLevel);
+            overflow.reservePercent = config.overflowReservePercent;
+            overflow.summaryInterval = std::chrono::milliseconds(config.dropSummaryMs);
+
+            // Copies of the records that a crash would otherwise take down with the queue
+            std::shared_ptr<CrashRingSink> crashRing;
+            if (!config.crashRingPath.empty()) {
+                try {
+                    crashRing = std::make_shared<CrashRingSink>(config.crashRingPath,
+                                                                config.crashRingMb * 1024 * 1024);
+                } catch (const std::exception& e) {
+                    spdlog::error("Failed to initialize crash ring: {}", e.what());
+                }
+            }
+
             // Create async logger
-            logger_ = std::make_shared<spdlog::async_logger>(
-                "async_logger",
-                sinks_.begin(),
-                sinks_.end(),
-                spdlog::thread_pool(),
-                spdlog::async_overflow_policy::block);
+            if (pipeline_) {
+                std::weak_ptr<AsyncPipeline> weakPipeline = pipeline_;
+                overflowGuard_ = std::make_shared<LevelOverflowGuard>(
+                    overflow,
+                    [weakPipeline]() {
+                        auto pipeline = weakPipeline.lock();
+                        return pipeline ? pipeline->producerCapacity() : 0;
+                    },
+                    [weakPipeline]() {
+                        auto pipeline = weakPipeline.lock();
+                        return pipeline ? pipeline->producerBacklog() : 0;
+                    },
+                    pipeline_->sharedBound());
+                // Worker i logs to fanout i
+                std::vector<spdlog::sink_ptr> loggerSinks(fanoutSinks.begin(), fanoutSinks.end());
+                auto queuedLogger = std::make_shared<QueuedLogger>(
+                    "async_logger",
+                    loggerSinks.begin(),
+                    loggerSinks.end(),
+                    pipeline_,
+                    spdlog::async_overflow_policy::block);
+                queuedLogger->setOverflowGuard(overflowGuard_);
+                queuedLogger->setPriorityLane(priorityLane);
+                queuedLogger->setCrashRing(crashRing);
+                pipeline_->start(queuedLogger.get());
+                logger_ = queuedLogger;
+            } else {
+                size_t poolCapacity = workerQueueSize * threadPools_.size();
+                overflowGuard_ = std::make_shared<LevelOverflowGuard>(
+                    overflow, [poolCapacity]() { return poolCapacity; }, threadPoolQueueSize());
+                // Delivered records give their bytes back after the fanout has written them
+                auto budgetRelease = std::make_shared<BudgetReleaseSink>(queueBudget_);
+                auto poolSlots = std::make_shared<PoolSlots>(threadPools_.size(), workerQueueSize);
+                std::vector<std::shared_ptr<spdlog::async_logger>> queueLoggers;
+                for (size_t i = 0; i < threadPools_.size(); ++i) {
+                    // The worker reports drops once it has delivered the last queued record
+                    std::weak_ptr<spdlog::details::thread_pool> weakPool = threadPools_[i];
+                    auto dropSummary = std::make_shared<DropSummarySink>(overflowGuard_, fanoutSinks[i], [weakPool]() {
+                        auto pool = weakPool.lock();
+                        return !pool || pool->queue_size() == 0;
+                    });
+                    auto slotRelease = std::make_shared<SlotReleaseSink>(poolSlots, i);
+                    std::vector<spdlog::sink_ptr> loggerSinks{fanoutSinks[i], budgetRelease, slotRelease, dropSummary};
+                    queueLoggers.push_back(std::make_shared<spdlog::async_logger>(
+                        "async_logger",
+                        loggerSinks.begin(),
+                        loggerSinks.end(),
+                        threadPools_[i],
+                        spdlog::async_overflow_policy::block));
+                }
+                auto front = std::make_shared<GuardedQueueSink>(std::move(queueLoggers), poolSlots, overflowGuard_,
+                                                                priorityLane, queueBudget_);
+                front->setCrashRing(crashRing);
+                logger_ = std::make_shared<spdlog::logger>("async_logger", std::move(front));
+            }
             logger_->set_level(logLevel);
             logger_->set_pattern(config.logPattern);
-            // Ensure logs are flushed immediately for debugging
-            logger_->flush_on(spdlog::level::trace);
+            // Flushing is decided per sink by the group-commit policy on the worker,
+            // the periodic flusher only covers records left behind by an idle queue
+            logger_->flush_on(spdlog::level::off);
+            if (flushPolicy.interval.count() > 0) {
+                std::weak_ptr<spdlog::logger> weakLogger = logger_;
+                flusher_ = std::make_unique<PeriodicFlusher>([weakLogger]() {
+                    if (auto logger = weakLogger.lock()) {
+                        logger->flush();
+                    }
+                }, flushPolicy.interval);
+            }
+            // Dumps are written to the logger's first sink, past its level filter
+            FlightRecorder::instance().start(recorder, logger_->sinks().front(), logger_->name());
             // Convert logModes to a comma-separated string manually
             std::string modes_str;
             for (size_t i = 0; i < config.logModes.size(); ++i) {
@@ -297,12 +741,16 @@ void LoggerFacade::initialize() {
                     modes_str += ", ";
                 }
             }
-            spdlog::info("Logger initialized. Modes: {}, File: {}, Network: {}:{}, Level: {}, UDP Format: {}",
-                         modes_str, config.filePath, config.networkIp, config.networkPort, config.logLevel, config.udpFormat);
+            spdlog::info("Logger initialized. Modes: {}, File: {}, Network: {}:{}, Level: {}, UDP Format: {}, UDP Batching: {}, Queue: {} ({} records, {} bytes, {} workers)",
+                         modes_str, config.filePath, config.networkIp, config.networkPort, config.logLevel, config.udpFormat,
+                         config.udpBatching ? "on" : "off", config.queueEngine, config.queueSize,
+                         config.queueBytes, config.workers);
         }
 
         spdlog::set_default_logger(logger_);
         isInitialized_ = true;
+        activeLogger_.store(logger_.get(), std::memory_order_release);
+        LevelGate::invalidateAll();
         // Flush logger to ensure initialization message is written
         logger_->flush();
     } catch (const std::exception& e) {
@@ -314,6 +762,8 @@ void LoggerFacade::initialize() {
         sinks_.clear();
         sinks_.push_back(std::make_shared<spdlog::sinks::null_sink_mt>());
         isInitialized_ = true;
+        activeLogger_.store(logger_.get(), std::memory_order_release);
+        LevelGate::invalidateAll();
     }
 }
 
@@ -323,10 +773,13 @@ void LoggerFacade::setLogLevel(spdlog::level::level_enum level) {
     }
 
     try {
-        logger_->set_level(level);
-        for (auto& sink : sinks_) {
-            sink->set_level(level);
+        {
+            std::lock_guard<std::mutex> lock(loggersMutex_);
+            logger_->set_level(level);
+            applyModuleLevels();
         }
+        LevelGate::invalidateAll(); // After set_level, so sites deciding again see the new level
+        BinaryLogger::instance().setLevel(level);
         spdlog::info("Log level changed to: {}", spdlog::level::to_string_view(level));
         // Flush logger after changing log level
         logger_->flush();
@@ -335,15 +788,60 @@ void LoggerFacade::setLogLevel(spdlog::level::level_enum level) {
     }
 }
 
+void LoggerFacade::setLogLevel(const std::string& name, spdlog::level::level_enum level) {
+    if (!isInitialized_) {
+        throw std::runtime_error("Logger not initialized. Call initialize() first.");
+    }
+    {
+        std::lock_guard<std::mutex> lock(loggersMutex_);
+        moduleLevels_[name] = level;
+        applyModuleLevels();
+    }
+    spdlog::info("Log level of {} changed to: {}", name, spdlog::level::to_string_view(level));
+}
+
 void LoggerFacade::shutdown() {
     if (isInitialized_) {
+        activeLogger_.store(nullptr, std::memory_order_release); // LOGIX_* calls from now on are dropped
+        LevelGate::invalidateAll();
+        FlightRecorder::instance().stop(); // Before the sinks its dumps go to
         // Flush all sinks before shutdown
         for (auto& sink : sinks_) {
             sink->flush();
         }
+        flusher_.reset();
         logger_->flush();
+        if (pipeline_) {
+            pipeline_->stop(); // Deliver queued records before the logger goes away
+        }
+        BinaryLogger::instance().stop(); // Writes out records still in the ring
+        calibrator_.reset();
         spdlog::shutdown(); // Clean up thread pool and logger
+        threadPools_.clear(); // Joins the workers once their queues are delivered
+        if (overflowGuard_) {
+            // Drops the workers had no chance to report, behind everything they delivered
+            postDropSummary(*overflowGuard_, [this](const spdlog::details::log_msg& summary) {
+                for (auto& sink : sinks_) {
+                    if (sink->should_log(summary.level)) {
+                        sink->log(summary);
+                    }
+                }
+            }, true);
+        }
+        for (auto& sink : sinks_) {
+            if (auto queue = std::dynamic_pointer_cast<AsyncSink>(sink)) {
+                queue->stop(); // Deliver what is still queued for this sink
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(loggersMutex_);
+            namedLoggers_.clear();
+        }
         logger_.reset();
+        overflowGuard_.reset();
+        queueBudget_.reset();
+        pipeline_.reset();
+        payloadPool_.reset(); // Released by the last queue holding it
         sinks_.clear();
         isInitialized_ = false;
         // Use console output as logger is shut down
@@ -351,6 +849,32 @@ void LoggerFacade::shutdown() {
     }
 }
 
+uint64_t LoggerFacade::droppedRecords(spdlog::level::level_enum level) const {
+    return overflowGuard_ ? overflowGuard_->dropped(level) : 0;
+}
+
+QueueBudget::Gauge LoggerFacade::queueGauge() const {
+    QueueBudget::Gauge total = queueBudget_ ? queueBudget_->gauge() : QueueBudget::Gauge();
+    for (const auto& sink : sinks_) {
+        if (auto queue = std::dynamic_pointer_cast<AsyncSink>(sink)) {
+            QueueBudget::Gauge gauge = queue->gauge();
+            total.bytes += gauge.bytes;
+            total.records += gauge.records;
+            total.peakBytes += gauge.peakBytes;
+            total.limitBytes += gauge.limitBytes;
+        }
+    }
+    return total;
+}
+
+PayloadPool::Stats LoggerFacade::payloadPoolStats() const {
+    return payloadPool_ ? payloadPool_->stats() : PayloadPool::Stats();
+}
+
+PriorityLatency::Snapshot LoggerFacade::priorityLatency() const {
+    return priorityLatency_ ? priorityLatency_->snapshot() : PriorityLatency::Snapshot();
+}
+
 std::shared_ptr<spdlog::logger> LoggerFacade::getLogger() const {
     if (!isInitialized_) {
         throw std::runtime_error("Logger not initialized. Call initialize() first.");
@@ -358,4 +882,25 @@ std::shared_ptr<spdlog::logger> LoggerFacade::getLogger() const {
     return logger_;
 }
 
+std::shared_ptr<spdlog::logger> LoggerFacade::getLogger(const std::string& name) {
+    if (!isInitialized_) {
+        throw std::runtime_error("Logger not initialized. Call initialize() first.");
+    }
+    std::lock_guard<std::mutex> lock(loggersMutex_);
+    auto& named = namedLoggers_[name];
+    if (!named) {
+        // Same sinks, queue and drop accounting; only name and level differ
+        auto front = logger_->sinks().size() == 1
+                         ? std::dynamic_pointer_cast<GuardedQueueSink>(logger_->sinks().front())
+                         : nullptr;
+        if (front) {
+            named = std::make_shared<spdlog::logger>(name, front->clone(name));
+        } else {
+            named = logger_->clone(name);
+        }
+        named->set_level(effectiveLevel(name));
+    }
+    return named;
+}
+
 } // namespace Logging
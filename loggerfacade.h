@@ -1,11 +1,31 @@
 #pragma once
+#include "activelevel.h"
+#include "flightrecorder.h"
+#include "levelgate.h"
+#include "logclock.h"
+#include "payloadpool.h"
+#include "prioritylane.h"
+#include "queuebudget.h"
+#include "threadtuning.h"
 #include <spdlog/spdlog.h>
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
+#include <utility>
 
 namespace Logging {
 
+class AsyncPipeline;
+class AsyncSink;
+class LevelOverflowGuard;
+class PeriodicFlusher;
+class TscCalibrator;
+
 class LoggerFacade {
 public:
     // Singleton instance
@@ -17,38 +37,219 @@ public:
     // Get the logger for use
     std::shared_ptr<spdlog::logger> getLogger() const;
 
-    // Change log level dynamically at runtime
+    // Child logger for a module, e.g. "net.udp", sharing the sinks and queue of
+    // the main logger. Its level is the one set for the nearest of "net.udp",
+    // "net" that has one, else the main logger's. Created on first use.
+    std::shared_ptr<spdlog::logger> getLogger(const std::string& name);
+
+    // Logger of the LOGIX_* macros, null before initialize() and once shutdown()
+    // has begun. Unlike getLogger() it neither throws nor touches a reference count.
+    spdlog::logger* activeLogger() const {
+        return activeLogger_.load(std::memory_order_acquire);
+    }
+
+    // Change log level dynamically at runtime. LOGIX_* call sites only notice
+    // level changes made here, not ones made on the spdlog logger directly.
     void setLogLevel(spdlog::level::level_enum level);
 
+    // Level of a module and the modules below it that have none of their own
+    void setLogLevel(const std::string& name, spdlog::level::level_enum level);
+
+    // Records of a level dropped because the async queue was full
+    uint64_t droppedRecords(spdlog::level::level_enum level) const;
+
+    // Bytes and records waiting in the async queue and the sink queues, summed
+    // over the queues, peaks and limits included
+    QueueBudget::Gauge queueGauge() const;
+
+    // Large payloads placed in the pool and those that fell back to the heap
+    PayloadPool::Stats payloadPoolStats() const;
+
+    // Time from logging a priority record to the file sink having flushed it
+    PriorityLatency::Snapshot priorityLatency() const;
+
     // Shutdown logger to clean up resources
     void shutdown();
 
 private:
-    LoggerFacade() = default;
-    ~LoggerFacade() = default;
+    LoggerFacade();
+    ~LoggerFacade();
 
     // Prevent copy/move
     LoggerFacade(const LoggerFacade&) = delete;
     LoggerFacade& operator=(const LoggerFacade&) = delete;
 
+    // Reports whether the active async queue has been emptied, for sinks that act at the end of a drain
+    std::function<bool()> queueDrainedProbe() const;
+
+    // Records queued in the spdlog engine's thread pools
+    std::function<size_t()> threadPoolQueueSize() const;
+
+    // Register a sink, behind its own queue if one is given
+    void addSink(spdlog::sink_ptr sink, const std::shared_ptr<AsyncSink>& queue);
+
+    // Level a named logger inherits; caller holds loggersMutex_
+    spdlog::level::level_enum effectiveLevel(const std::string& name) const;
+
+    // Re-derive the levels of all named loggers; caller holds loggersMutex_
+    void applyModuleLevels();
+
     std::shared_ptr<spdlog::logger> logger_;
+    std::atomic<spdlog::logger*> activeLogger_{nullptr}; // logger_ while logging is open
     bool isInitialized_ = false;
-    std::vector<spdlog::sink_ptr> sinks_; // Store sinks for dynamic level changes
+    std::vector<spdlog::sink_ptr> sinks_; // Flushed and stopped at shutdown
+    std::mutex loggersMutex_;
+    std::map<std::string, std::shared_ptr<spdlog::logger>> namedLoggers_;
+    std::map<std::string, spdlog::level::level_enum> moduleLevels_; // Levels set for modules, inherited below them
+    std::shared_ptr<AsyncPipeline> pipeline_; // Facade-owned queue engine, unset for the spdlog thread pool
+    std::vector<std::shared_ptr<spdlog::details::thread_pool>> threadPools_; // spdlog engine, one per worker
+    std::unique_ptr<PeriodicFlusher> flusher_; // Only set for an interval flush policy
+    std::unique_ptr<TscCalibrator> calibrator_; // Only set for the tsc clock
+    std::shared_ptr<LevelOverflowGuard> overflowGuard_; // Drop accounting of the async queue
+    std::shared_ptr<QueueBudget> queueBudget_; // Byte bound of the async queue
+    std::shared_ptr<PayloadPool> payloadPool_; // Storage of large queued payloads
+    std::shared_ptr<PriorityLatency> priorityLatency_; // Kept across shutdown for reporting
 };
 
 // Configuration class to handle environment variables
 struct LoggerConfig {
-    std::vector<std::string> logModes; // List of modes: none, file, network
+    std::vector<std::string> logModes; // List of modes: none, file, network, binary
     std::string filePath;
+    std::string binaryPath; // Output of the LOGIX_BIN_* macros in binary mode
     std::string networkIp;
     uint16_t networkPort = 0;
     size_t fileSizeMb = 1;
-    size_t numberOfLogFiles = 1;
+    size_t numberOfLogFiles = 3; // Archives kept besides the active file
+    size_t fileTotalMb = 0; // Disk budget for the log file and its archives, 0 disables
+    bool fileCompress = true; // gzip rotated files in the background
     std::string logLevel = "debug";
+    std::vector<std::pair<std::string, spdlog::level::level_enum>> moduleLevels; // Named logger levels, "net=debug,db=warn"
     std::string logPattern = "%Y-%m-%d %H:%M:%S.%e [%n] [%l] %v"; // Default pattern
     std::string udpFormat = "json"; // Default: JSON for UDP sink
+    std::string queueEngine = "spdlog"; // "spdlog" thread pool, lock-free "mpsc" ring or per-thread "spsc" rings
+    size_t queueSize = 8192; // Async queue capacity in records, split among the workers
+    size_t workers = 1; // Async worker threads, each serving a fixed share of the producer threads
+    ThreadTuning threadTuning; // CPU set, nice value, scheduling class and names of background threads
+    size_t queueBytes = 32 * 1024 * 1024; // Payload bytes the async queue may hold
+    size_t payloadPoolBytes = 8 * 1024 * 1024; // Preallocated blocks for payloads too large for a slot
+    size_t threadQueueSize = 1024; // Per-thread ring capacity for the spsc engine
+    std::string priorityLevel = "off"; // Records at or above skip the async queue, ahead of the thread's earlier records
+    bool prioritySync = false; // Block the logging thread until its priority record is flushed
+    std::string overflowBlockLevel = "warn"; // On a full queue, records below this level are dropped ("trace" blocks all)
+    size_t overflowReservePercent = 10; // Share of the queue kept for records at or above the block level
+    size_t dropSummaryMs = 1000; // Min interval between "records dropped" summaries
+    std::string flushLevel = "error"; // Flush at or above this level ("off" disables)
+    size_t flushIntervalMs = 0; // Flush records older than this, 0 disables
+    size_t flushBytes = 0; // Flush once this many bytes are pending, 0 disables
+    bool flushOnDrain = true; // Flush whenever the async queue runs empty
+    bool flushSync = false; // fdatasync the log file after each flush
+    std::string udpTimeFormat = "local"; // JSON "time": local, utc, iso8601 or epoch_ns
+    std::string clockSource = "realtime"; // Hot-path record clock: realtime, coarse or tsc
+    std::string udpTransport = "posix"; // "posix", or "qt" when built with QtNetwork
+    size_t udpSendBufferBytes = 1024 * 1024; // SO_SNDBUF for the POSIX transport
+    bool udpBatching = false; // Coalesce UDP records into MTU-sized datagrams
+    size_t udpMtu = 1472; // Max datagram payload when batching
+    size_t udpBatchLingerMs = 5; // Max time a batched record waits for more records
+    bool sinkQueues = true; // Give every sink its own queue and worker thread
+    size_t sinkQueueSize = 8192; // Default per-sink queue capacity in records
+    size_t consoleQueueSize = 0; // Per-sink overrides, 0 uses sinkQueueSize
+    size_t fileQueueSize = 0;
+    size_t networkQueueSize = 0;
+    std::string consoleOverflow = "block"; // "block" or "drop" when the sink's queue is full
+    std::string fileOverflow = "block";
+    std::string networkOverflow = "block";
+    size_t consoleDedupMs = 0; // Collapse bursts of identical records within this window, 0 keeps every record
+    size_t fileDedupMs = 0;
+    size_t networkDedupMs = 0;
+    std::string flightRecorderLevel = "off"; // Keep records from this level up to the logger's in per-thread rings
+    size_t flightRecorderSize = 256; // Records kept per thread
+    std::string flightRecorderTrigger = "error"; // Dump the rings at or above this level ("off": SIGUSR1 only)
+    std::string crashRingPath; // Memory-mapped ring every record is copied to before queuing, empty disables
+    size_t crashRingMb = 4; // Size of the crash ring
 
     static LoggerConfig loadFromEnv();
 };
 
+// Log through logger with a LogClock time instead of the one spdlog would take;
+// a raw TSC stamp is turned into wall time on the worker
+template <typename... Args>
+void logStamped(spdlog::logger& logger, spdlog::source_loc loc, spdlog::level::level_enum level,
+                spdlog::format_string_t<Args...> format, Args&&... args) {
+    spdlog::log_clock::time_point time = LogClock::now();
+    spdlog::memory_buf_t buf;
+    try {
+        fmt::format_to(std::back_inserter(buf), format, std::forward<Args>(args)...);
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "[*** LOG ERROR ***] [%s] %s\n", logger.name().c_str(), ex.what());
+        return;
+    }
+    logger.log(time, loc, level, spdlog::string_view_t(buf.data(), buf.size()));
+}
+
+// A single argument, written as it would be with "{}"
+template <typename T>
+void logStamped(spdlog::logger& logger, spdlog::source_loc loc, spdlog::level::level_enum level, const T& msg) {
+    logStamped(logger, loc, level, "{}", msg);
+}
+
 } // namespace Logging
+
+// Logging macros. The level is checked before any argument is evaluated, the call
+// site is passed on as source_loc, and levels below LOGIX_ACTIVE_LEVEL compile to
+// nothing. Before initialize() and after shutdown() they do nothing. Each site
+// caches its level decision until LoggerFacade::setLogLevel() changes the level;
+// LOGIX_LOG therefore takes a constant level. Records are stamped with LogClock,
+// so LOG_CLOCK applies to them. With the flight recorder on, records below the
+// logger's level go to the calling thread's trace ring instead.
+#define LOGIX_LOG(level, ...)                                                                               \
+    do {                                                                                                    \
+        static ::Logging::LevelGate logixGate_(level);                                                      \
+        ::Logging::LevelGate::Decision logixDecision_ = logixGate_.decide();                                \
+        if (logixDecision_ == ::Logging::LevelGate::Log) {                                                  \
+            spdlog::logger* logixLogger_ = ::Logging::LoggerFacade::getInstance().activeLogger();           \
+            if (logixLogger_) {                                                                             \
+                ::Logging::logStamped(*logixLogger_, spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION},\
+                                      level, __VA_ARGS__);                                                  \
+            }                                                                                               \
+        } else if (logixDecision_ == ::Logging::LevelGate::Record) {                                        \
+            static std::atomic<uint32_t> logixSite_{0};                                                     \
+            ::Logging::FlightRecorder::instance().record(logixSite_, level, __FILE__, __LINE__,             \
+                                                         __VA_ARGS__);                                      \
+        }                                                                                                   \
+    } while (0)
+
+#if LOGIX_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define LOGIX_TRACE(...) LOGIX_LOG(spdlog::level::trace, __VA_ARGS__)
+#else
+#define LOGIX_TRACE(...) (void)0
+#endif
+
+#if LOGIX_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define LOGIX_DEBUG(...) LOGIX_LOG(spdlog::level::debug, __VA_ARGS__)
+#else
+#define LOGIX_DEBUG(...) (void)0
+#endif
+
+#if LOGIX_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define LOGIX_INFO(...) LOGIX_LOG(spdlog::level::info, __VA_ARGS__)
+#else
+#define LOGIX_INFO(...) (void)0
+#endif
+
+#if LOGIX_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
+#define LOGIX_WARN(...) LOGIX_LOG(spdlog::level::warn, __VA_ARGS__)
+#else
+#define LOGIX_WARN(...) (void)0
+#endif
+
+#if LOGIX_ACTIVE_LEVEL <= SPDLOG_LEVEL_ERROR
+#define LOGIX_ERROR(...) LOGIX_LOG(spdlog::level::err, __VA_ARGS__)
+#else
+#define LOGIX_ERROR(...) (void)0
+#endif
+
+#if LOGIX_ACTIVE_LEVEL <= SPDLOG_LEVEL_CRITICAL
+#define LOGIX_CRITICAL(...) LOGIX_LOG(spdlog::level::critical, __VA_ARGS__)
+#else
+#define LOGIX_CRITICAL(...) (void)0
+#endif
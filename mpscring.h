@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace Logging {
+
+constexpr size_t kCacheLineSize = 64;
+
+// Ring capacities are powers of two so positions map to slots with a mask
+inline size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Bounded lock-free multi-producer/single-consumer ring (Vyukov-style sequenced
+// slots). Producers claim a position with one CAS and publish through the slot's
+// sequence number, so they never touch a lock or each other's slots. Each slot
+// sits on its own cache lines to avoid false sharing between neighbours.
+template <typename T>
+class MpscRing {
+public:
+    explicit MpscRing(size_t capacity)
+        : capacity_(roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity)),
+          mask_(capacity_ - 1),
+          slots_(new Slot[capacity_]) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // Claim a free slot and let fill(T&) write it in place; false when the ring is full
+    template <typename Fill>
+    bool tryPush(Fill&& fill) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        fill(slot->value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only: hand the oldest published value to take(T&); false when empty
+    template <typename Take>
+    bool tryPop(Take&& take) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[pos & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+        take(slot.value);
+        slot.sequence.store(pos + capacity_, std::memory_order_release);
+        tail_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only: peek at the oldest published value without removing it
+    const T* front() const {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        const Slot& slot = slots_[pos & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return nullptr;
+        }
+        return &slot.value;
+    }
+
+    // Approximate when producers are active
+    size_t size() const {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct alignas(kCacheLineSize) Slot {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(kCacheLineSize) std::atomic<size_t> head_{0}; // Next position producers claim
+    alignas(kCacheLineSize) std::atomic<size_t> tail_{0}; // Next position the consumer reads
+};
+
+} // namespace Logging
@@ -0,0 +1,196 @@
+#include "overflowguard.h"
+#include "asyncpipeline.h"
+#include <algorithm>
+#include <iterator>
+
+namespace Logging {
+
+LevelOverflowGuard::LevelOverflowGuard(LevelOverflowOptions options, std::function<size_t()> capacity,
+                                       std::function<size_t()> queuedRecords, bool sharedBound)
+    : options_(options), capacity_(std::move(capacity)), sharedBound_(sharedBound),
+      queuedRecords_(std::move(queuedRecords)) {
+    if (sharedBound_) {
+        // A shared bound does not change, so neither does the limit
+        size_t total = capacity_();
+        admitLimit_ = total - total * std::min<size_t>(options_.reservePercent, 100) / 100;
+    }
+}
+
+bool LevelOverflowGuard::admit(spdlog::level::level_enum level) {
+    if (blocks(level) || !sharedBound_ || queuedRecords_() < admitLimit_) {
+        return true;
+    }
+    countDrop(level);
+    return false;
+}
+
+void LevelOverflowGuard::countDrop(spdlog::level::level_enum level) {
+    dropped_[static_cast<size_t>(level)].fetch_add(1, std::memory_order_relaxed);
+    totalDropped_.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t LevelOverflowGuard::dropped(spdlog::level::level_enum level) const {
+    return dropped_[static_cast<size_t>(level)].load(std::memory_order_relaxed);
+}
+
+bool LevelOverflowGuard::takeSummary(std::string& text, bool drained) {
+    // The common case, nothing dropped since the last summary, costs two loads
+    if (!pendingDrops()) {
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(summaryMutex_, std::defer_lock);
+    if (drained) {
+        lock.lock();
+    } else {
+        if (queuedRecords_() > capacity_() / 2) {
+            return false; // Still under pressure
+        }
+        if (!lock.try_lock()) {
+            return false;
+        }
+    }
+    auto now = spdlog::log_clock::now();
+    if (!drained && now - lastSummary_ < options_.summaryInterval) {
+        return false;
+    }
+
+    uint64_t total = 0;
+    std::string perLevel;
+    for (size_t level = 0; level < dropped_.size(); ++level) {
+        uint64_t count = dropped_[level].load(std::memory_order_relaxed);
+        uint64_t delta = count - reported_[level];
+        reported_[level] = count;
+        if (delta > 0) {
+            total += delta;
+            fmt::format_to(std::back_inserter(perLevel), "{}{}: {}", perLevel.empty() ? "" : ", ",
+                           spdlog::level::to_string_view(static_cast<spdlog::level::level_enum>(level)), delta);
+        }
+    }
+    totalReported_.fetch_add(total, std::memory_order_relaxed);
+    lastSummary_ = now;
+    if (total == 0) {
+        return false;
+    }
+    text = fmt::format("Async queue overflow: dropped {} log records ({})", total, perLevel);
+    return true;
+}
+
+void postDropSummary(LevelOverflowGuard& guard, const std::function<void(const spdlog::details::log_msg&)>& post,
+                     bool drained) {
+    std::string text;
+    if (guard.takeSummary(text, drained)) {
+        post(spdlog::details::log_msg("logix", spdlog::level::warn, text));
+    }
+}
+
+DropSummarySink::DropSummarySink(std::shared_ptr<LevelOverflowGuard> guard, spdlog::sink_ptr target,
+                                 std::function<bool()> drained)
+    : guard_(std::move(guard)), target_(std::move(target)), drained_(std::move(drained)) {
+    set_level(spdlog::level::trace);
+}
+
+void DropSummarySink::log(const spdlog::details::log_msg&) {
+    // The pool's queue is only asked while drops are unreported
+    if (guard_->pendingDrops() && drained_()) {
+        postDropSummary(*guard_, [this](const spdlog::details::log_msg& summary) {
+            target_->log(summary);
+        }, true);
+    }
+}
+
+PoolSlots::PoolSlots(size_t pools, size_t capacity) : capacity_(capacity), used_(new Counter[pools]) {}
+
+bool PoolSlots::tryTake(size_t pool) {
+    auto& count = used_[pool].count;
+    size_t used = count.load(std::memory_order_relaxed);
+    do {
+        if (used >= capacity_) {
+            return false;
+        }
+    } while (!count.compare_exchange_weak(used, used + 1, std::memory_order_relaxed));
+    return true;
+}
+
+GuardedQueueSink::GuardedQueueSink(std::vector<std::shared_ptr<spdlog::async_logger>> queues,
+                                   std::shared_ptr<PoolSlots> slots, std::shared_ptr<LevelOverflowGuard> guard,
+                                   std::shared_ptr<PriorityLane> priorityLane, std::shared_ptr<QueueBudget> budget)
+    : queues_(std::move(queues)), slots_(std::move(slots)), guard_(std::move(guard)), priorityLane_(std::move(priorityLane)),
+      budget_(std::move(budget)) {
+    for (auto& queue : queues_) {
+        queue->set_level(spdlog::level::trace);
+    }
+}
+
+void GuardedQueueSink::log(const spdlog::details::log_msg& msg) {
+    if (crashRing_) {
+        crashRing_->log(msg);
+    }
+    // The async logger stamps its own name on records; thread id and time carry over
+    postDropSummary(*guard_, [this](const spdlog::details::log_msg& summary) {
+        enqueue(summary, true);
+    });
+    if (priorityLane_ && priorityLane_->accepts(msg.level)) {
+        priorityLane_->log(msg);
+        return;
+    }
+    // Admitted records may still meet a full queue when producers race for the
+    // last reserved slots; droppable ones are dropped then, the others wait
+    if (guard_->admit(msg.level)) {
+        enqueue(msg, guard_->blocks(msg.level));
+    }
+}
+
+std::shared_ptr<GuardedQueueSink> GuardedQueueSink::clone(const std::string& name) const {
+    std::vector<std::shared_ptr<spdlog::async_logger>> queues;
+    for (const auto& queue : queues_) {
+        queues.push_back(std::static_pointer_cast<spdlog::async_logger>(queue->clone(name)));
+    }
+    auto cloned = std::make_shared<GuardedQueueSink>(std::move(queues), slots_, guard_, priorityLane_, budget_);
+    cloned->crashRing_ = crashRing_;
+    return cloned;
+}
+
+void GuardedQueueSink::enqueue(const spdlog::details::log_msg& msg, bool block) {
+    size_t shard = producerShard(queues_.size());
+    auto& queue = queues_[shard];
+    if (block) {
+        slots_->take(shard);
+    } else if (!slots_->tryTake(shard)) {
+        guard_->countDrop(msg.level);
+        return;
+    }
+    if (!budget_) {
+        queue->log(msg.time, msg.source, msg.level, msg.payload);
+        return;
+    }
+    spdlog::details::log_msg queued = budget_->fit(msg);
+    if (block) {
+        budget_->acquire(queued.payload.size());
+    } else if (!budget_->tryAcquire(queued.payload.size(), false)) {
+        slots_->release(shard);
+        guard_->countDrop(msg.level);
+        return;
+    }
+    queue->log(queued.time, queued.source, queued.level, queued.payload);
+}
+
+void GuardedQueueSink::flush() {
+    for (size_t i = 0; i < queues_.size(); ++i) {
+        slots_->take(i);
+        queues_[i]->flush();
+    }
+}
+
+void GuardedQueueSink::set_pattern(const std::string& pattern) {
+    for (auto& queue : queues_) {
+        queue->set_pattern(pattern);
+    }
+}
+
+void GuardedQueueSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) {
+    for (auto& queue : queues_) {
+        queue->set_formatter(sink_formatter->clone());
+    }
+}
+
+} // namespace Logging
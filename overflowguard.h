@@ -0,0 +1,192 @@
+#pragma once
+#include <spdlog/async_logger.h>
+#include "crashring.h"
+#include "prioritylane.h"
+#include "queuebudget.h"
+#include <spdlog/sinks/sink.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Logging {
+
+// How a saturated async queue treats records of different levels
+struct LevelOverflowOptions {
+    spdlog::level::level_enum blockLevel = spdlog::level::warn; // At or above: wait for room, below: drop
+    size_t reservePercent = 10; // Share of the queue only records at blockLevel and above may use
+    std::chrono::milliseconds summaryInterval{1000}; // Min time between two drop summaries
+};
+
+// Level-aware admission in front of an async queue. Records below the block level
+// are dropped rather than wait, and already once the queue has filled up to its
+// reserve, so warnings and errors still find room. Drops are counted exactly per
+// level. A summary is handed out once the queue has room again, and whenever
+// the queue's worker finds it drained.
+class LevelOverflowGuard {
+public:
+    // capacity and queuedRecords describe the queue as the calling producer sees it.
+    // Without a shared bound (per-thread rings) only the queue's own non-blocking
+    // push drops records, and both only serve the summary's pressure check.
+    LevelOverflowGuard(LevelOverflowOptions options, std::function<size_t()> capacity,
+                       std::function<size_t()> queuedRecords, bool sharedBound = true);
+
+    // True if the record should wait for room rather than be dropped
+    bool blocks(spdlog::level::level_enum level) const {
+        return level >= options_.blockLevel;
+    }
+
+    // False, and counted, if a droppable record finds the queue past its reserve
+    bool admit(spdlog::level::level_enum level);
+
+    // Count a record the queue itself refused
+    void countDrop(spdlog::level::level_enum level);
+
+    uint64_t dropped(spdlog::level::level_enum level) const;
+
+    // True if drops have not been reported yet; two loads
+    bool pendingDrops() const {
+        return totalDropped_.load(std::memory_order_acquire) != totalReported_.load(std::memory_order_relaxed);
+    }
+
+    // Text of a "records dropped" summary, if drops are unreported, the queue is
+    // at most half full and the last summary is old enough. A drained queue, as
+    // its worker or shutdown sees it, gets its summary regardless.
+    bool takeSummary(std::string& text, bool drained = false);
+
+private:
+    LevelOverflowOptions options_;
+    std::function<size_t()> capacity_;
+    bool sharedBound_;
+    size_t admitLimit_ = 0; // Queue length up to which droppable records are admitted
+    std::function<size_t()> queuedRecords_;
+
+    std::array<std::atomic<uint64_t>, spdlog::level::n_levels> dropped_{};
+    std::atomic<uint64_t> totalDropped_{0};
+
+    std::mutex summaryMutex_; // Only one thread writes a summary at a time
+    std::array<uint64_t, spdlog::level::n_levels> reported_{};
+    std::atomic<uint64_t> totalReported_{0};
+    spdlog::log_clock::time_point lastSummary_;
+};
+
+// Hand a drop summary record to post, if one is due
+void postDropSummary(LevelOverflowGuard& guard, const std::function<void(const spdlog::details::log_msg&)>& post,
+                     bool drained = false);
+
+// Last sink of spdlog's async logger: once the worker has delivered the last
+// record queued on its pool, writes a pending drop summary to target
+class DropSummarySink : public spdlog::sinks::sink {
+public:
+    DropSummarySink(std::shared_ptr<LevelOverflowGuard> guard, spdlog::sink_ptr target,
+                    std::function<bool()> drained);
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void flush() override {}
+    void set_pattern(const std::string&) override {}
+    void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+private:
+    std::shared_ptr<LevelOverflowGuard> guard_;
+    spdlog::sink_ptr target_;
+    std::function<bool()> drained_;
+};
+
+// Records queued on each of spdlog's thread pools, counted by the producers that
+// post them and the workers that deliver them. spdlog 1.10 has no non-blocking
+// enqueue short of overrun_oldest, which would evict the oldest record whatever
+// its level; a droppable record takes a slot only if one is free instead, so it
+// never waits on the pool's queue.
+class PoolSlots {
+public:
+    PoolSlots(size_t pools, size_t capacity);
+
+    // Claim a slot on pool if its queue has room
+    bool tryTake(size_t pool);
+
+    // Claim a slot on pool regardless; the post may wait for room
+    void take(size_t pool) {
+        used_[pool].count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release(size_t pool) {
+        used_[pool].count.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    struct alignas(64) Counter {
+        std::atomic<size_t> count{0};
+    };
+
+    size_t capacity_;
+    std::unique_ptr<Counter[]> used_;
+};
+
+// Sink of a pool's async logger giving back the slot of each delivered record and flush
+class SlotReleaseSink : public spdlog::sinks::sink {
+public:
+    SlotReleaseSink(std::shared_ptr<PoolSlots> slots, size_t pool) : slots_(std::move(slots)), pool_(pool) {
+        set_level(spdlog::level::trace);
+    }
+
+    void log(const spdlog::details::log_msg&) override {
+        slots_->release(pool_);
+    }
+    void flush() override {
+        slots_->release(pool_);
+    }
+    void set_pattern(const std::string&) override {}
+    void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+private:
+    std::shared_ptr<PoolSlots> slots_;
+    size_t pool_;
+};
+
+// Front for spdlog's thread pool loggers, which cannot be subclassed: the facade's
+// logger logs synchronously into this sink, which applies the guard and passes
+// admitted records on to an async logger. With several async loggers, each on its
+// own single-threaded pool, a producer thread always uses the same one. Records the priority lane accepts skip
+// the queue. Every record and flush holds a slot of its pool until the pool's
+// SlotReleaseSink gives it back, and droppable records that find none are dropped.
+// With a budget, queued records also hold their payload bytes until a
+// BudgetReleaseSink among the async logger's sinks releases them. Patterns and
+// flushes are forwarded.
+class GuardedQueueSink : public spdlog::sinks::sink {
+public:
+    GuardedQueueSink(std::vector<std::shared_ptr<spdlog::async_logger>> queues, std::shared_ptr<PoolSlots> slots,
+                     std::shared_ptr<LevelOverflowGuard> guard,
+                     std::shared_ptr<PriorityLane> priorityLane = nullptr,
+                     std::shared_ptr<QueueBudget> budget = nullptr);
+
+    // Front for a child logger. spdlog's async loggers stamp records with their
+    // own name, so the clone's async loggers carry name; the pools, slots,
+    // guard, lane and budget are shared.
+    std::shared_ptr<GuardedQueueSink> clone(const std::string& name) const;
+
+    // Every record is written here on the logging thread, before it is queued
+    void setCrashRing(std::shared_ptr<CrashRingSink> ring) {
+        crashRing_ = std::move(ring);
+    }
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void flush() override;
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+private:
+    void enqueue(const spdlog::details::log_msg& msg, bool block);
+
+    std::vector<std::shared_ptr<spdlog::async_logger>> queues_;
+    std::shared_ptr<PoolSlots> slots_;
+    std::shared_ptr<LevelOverflowGuard> guard_;
+    std::shared_ptr<PriorityLane> priorityLane_;
+    std::shared_ptr<QueueBudget> budget_;
+    std::shared_ptr<CrashRingSink> crashRing_;
+};
+
+} // namespace Logging
@@ -0,0 +1,156 @@
+#include "payloadpool.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace Logging {
+
+PayloadPool::PayloadPool(size_t slabBytes) {
+    size_t perClass = slabBytes / classes_.size();
+    size_t total = 0;
+    for (size_t i = 0; i < classes_.size(); ++i) {
+        classes_[i].blockSize = kBlockSizes[i];
+        classes_[i].blocks = std::min<size_t>(perClass / kBlockSizes[i], UINT32_MAX - 1);
+        total += classes_[i].blocks * kBlockSizes[i];
+    }
+    slab_.reset(new char[total]);
+    char* begin = slab_.get();
+    for (auto& sizeClass : classes_) {
+        sizeClass.begin = begin;
+        begin += sizeClass.blocks * sizeClass.blockSize;
+        sizeClass.next.reset(new std::atomic<uint32_t>[sizeClass.blocks]);
+        // Stack every block, lowest address on top
+        for (size_t index = sizeClass.blocks; index-- > 0;) {
+            push(sizeClass, static_cast<uint32_t>(index));
+        }
+    }
+}
+
+char* PayloadPool::allocate(size_t size) {
+    for (auto& sizeClass : classes_) {
+        if (size <= sizeClass.blockSize) {
+            if (char* block = pop(sizeClass)) {
+                pooled_.fetch_add(1, std::memory_order_relaxed);
+                return block;
+            }
+            // A larger class would waste more than it saves, leave it to the heap
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+void PayloadPool::release(char* block) {
+    for (auto& sizeClass : classes_) {
+        if (block >= sizeClass.begin && block < sizeClass.begin + sizeClass.blocks * sizeClass.blockSize) {
+            push(sizeClass, static_cast<uint32_t>((block - sizeClass.begin) / sizeClass.blockSize));
+            return;
+        }
+    }
+}
+
+PayloadPool::Stats PayloadPool::stats() const {
+    Stats stats;
+    stats.pooled = pooled_.load(std::memory_order_relaxed);
+    stats.fallback = fallback_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+char* PayloadPool::pop(SizeClass& sizeClass) {
+    uint64_t head = sizeClass.head.load(std::memory_order_acquire);
+    for (;;) {
+        auto top = static_cast<uint32_t>(head);
+        if (top == 0) {
+            return nullptr;
+        }
+        // A stale link is harmless: the tag makes the exchange fail if head moved
+        uint32_t next = sizeClass.next[top - 1].load(std::memory_order_relaxed);
+        uint64_t tag = (head >> 32) + 1;
+        if (sizeClass.head.compare_exchange_weak(head, tag << 32 | next, std::memory_order_acquire,
+                                                 std::memory_order_acquire)) {
+            return sizeClass.begin + static_cast<size_t>(top - 1) * sizeClass.blockSize;
+        }
+    }
+}
+
+void PayloadPool::push(SizeClass& sizeClass, uint32_t index) {
+    uint64_t head = sizeClass.head.load(std::memory_order_relaxed);
+    for (;;) {
+        sizeClass.next[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        uint64_t tag = (head >> 32) + 1;
+        if (sizeClass.head.compare_exchange_weak(head, tag << 32 | (index + 1), std::memory_order_release,
+                                                 std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+PooledMessage::PooledMessage(PooledMessage&& other) noexcept {
+    moveFrom(other);
+}
+
+PooledMessage& PooledMessage::operator=(PooledMessage&& other) noexcept {
+    if (this != &other) {
+        reset();
+        moveFrom(other);
+    }
+    return *this;
+}
+
+void PooledMessage::assign(const spdlog::details::log_msg& msg, PayloadPool* pool) {
+    reset();
+    msg_ = msg;
+    size_t size = msg.logger_name.size() + msg.payload.size();
+    if (size > kInlineBytes) {
+        external_ = pool ? pool->allocate(size) : nullptr;
+        if (external_) {
+            pool_ = pool;
+        } else {
+            if (pool) {
+                pool->countFallback();
+            }
+            external_ = new char[size];
+        }
+    }
+    char* data = storage();
+    std::memcpy(data, msg.logger_name.data(), msg.logger_name.size());
+    std::memcpy(data + msg.logger_name.size(), msg.payload.data(), msg.payload.size());
+    point(data);
+}
+
+void PooledMessage::reset() {
+    if (external_) {
+        if (pool_) {
+            pool_->release(external_);
+        } else {
+            delete[] external_;
+        }
+        external_ = nullptr;
+        pool_ = nullptr;
+    }
+    msg_.logger_name = spdlog::string_view_t();
+    msg_.payload = spdlog::string_view_t();
+}
+
+void PooledMessage::point(char* data) {
+    size_t nameSize = msg_.logger_name.size();
+    msg_.logger_name = spdlog::string_view_t(data, nameSize);
+    msg_.payload = spdlog::string_view_t(data + nameSize, msg_.payload.size());
+}
+
+void PooledMessage::moveFrom(PooledMessage& other) {
+    msg_ = other.msg_;
+    if (other.external_) {
+        external_ = other.external_;
+        pool_ = other.pool_;
+        other.external_ = nullptr;
+        other.pool_ = nullptr;
+    } else {
+        // Only the bytes in use are copied, not the whole inline buffer
+        std::memcpy(inline_, other.inline_, msg_.logger_name.size() + msg_.payload.size());
+        point(inline_);
+    }
+    other.reset();
+}
+
+} // namespace Logging
@@ -0,0 +1,95 @@
+#pragma once
+#include <spdlog/details/log_msg.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace Logging {
+
+// Fixed-size blocks for payloads too large to live inline in a queue slot, carved
+// out of one slab allocated up front. Each size class keeps its free blocks on a
+// lock-free stack, so producers take and the worker returns blocks without a lock
+// and without going through malloc. Payloads larger than the largest class, or
+// meeting an exhausted class, fall back to the heap; those are counted.
+class PayloadPool {
+public:
+    static constexpr std::array<size_t, 4> kBlockSizes = {1024, 4096, 16384, 65536};
+
+    struct Stats {
+        uint64_t pooled = 0;   // Payloads placed in a pool block
+        uint64_t fallback = 0; // Payloads that had to go to the heap
+    };
+
+    // slabBytes is shared equally among the size classes
+    explicit PayloadPool(size_t slabBytes);
+
+    PayloadPool(const PayloadPool&) = delete;
+    PayloadPool& operator=(const PayloadPool&) = delete;
+
+    // A block of at least size bytes, or nullptr if the caller must use the heap
+    char* allocate(size_t size);
+
+    // Give back a block returned by allocate()
+    void release(char* block);
+
+    // Count a payload that did not get a block
+    void countFallback() {
+        fallback_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Stats stats() const;
+
+private:
+    struct SizeClass {
+        size_t blockSize = 0;
+        size_t blocks = 0;
+        char* begin = nullptr; // Within slab_
+        std::unique_ptr<std::atomic<uint32_t>[]> next; // Free list links, block index + 1
+        std::atomic<uint64_t> head{0}; // ABA tag << 32 | top block index + 1, 0 when empty
+    };
+
+    char* pop(SizeClass& sizeClass);
+    void push(SizeClass& sizeClass, uint32_t index);
+
+    std::unique_ptr<char[]> slab_;
+    std::array<SizeClass, kBlockSizes.size()> classes_;
+    std::atomic<uint64_t> pooled_{0};
+    std::atomic<uint64_t> fallback_{0};
+};
+
+// Owning copy of a log_msg for a queue slot. Logger name and payload are kept in
+// the slot itself when they fit, otherwise in a pool block or, failing that, on
+// the heap, so steady-state logging of ordinary messages allocates nothing.
+class PooledMessage {
+public:
+    static constexpr size_t kInlineBytes = 256;
+
+    PooledMessage() = default;
+    PooledMessage(const PooledMessage&) = delete;
+    PooledMessage& operator=(const PooledMessage&) = delete;
+    PooledMessage(PooledMessage&& other) noexcept;
+    PooledMessage& operator=(PooledMessage&& other) noexcept;
+    ~PooledMessage() { reset(); }
+
+    // pool may be null, then large payloads always go to the heap
+    void assign(const spdlog::details::log_msg& msg, PayloadPool* pool);
+
+    // Drop the copy and give back its block
+    void reset();
+
+    const spdlog::details::log_msg& msg() const { return msg_; }
+    spdlog::details::log_msg& msg() { return msg_; }
+
+private:
+    char* storage() { return external_ ? external_ : inline_; }
+    void point(char* data);
+    void moveFrom(PooledMessage& other);
+
+    spdlog::details::log_msg msg_; // Name and payload view into storage()
+    char* external_ = nullptr;
+    PayloadPool* pool_ = nullptr; // Owner of external_, null for heap blocks
+    char inline_[kInlineBytes];
+};
+
+} // namespace Logging
@@ -0,0 +1,42 @@
+#include "prioritylane.h"
+#include "logclock.h"
+
+namespace Logging {
+
+void PriorityLatency::record(spdlog::log_clock::time_point logged) {
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(spdlog::log_clock::now() - LogClock::resolve(logged)).count();
+    count_.fetch_add(1, std::memory_order_relaxed);
+    totalNs_.fetch_add(ns, std::memory_order_relaxed);
+    lastNs_.store(ns, std::memory_order_relaxed);
+    int64_t max = maxNs_.load(std::memory_order_relaxed);
+    while (ns > max && !maxNs_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+}
+
+PriorityLatency::Snapshot PriorityLatency::snapshot() const {
+    Snapshot snapshot;
+    snapshot.count = count_.load(std::memory_order_relaxed);
+    snapshot.last = std::chrono::nanoseconds(lastNs_.load(std::memory_order_relaxed));
+    snapshot.max = std::chrono::nanoseconds(maxNs_.load(std::memory_order_relaxed));
+    if (snapshot.count > 0) {
+        snapshot.mean = std::chrono::nanoseconds(totalNs_.load(std::memory_order_relaxed) /
+                                                 static_cast<int64_t>(snapshot.count));
+    }
+    return snapshot;
+}
+
+PriorityLane::PriorityLane(spdlog::level::level_enum level, spdlog::sink_ptr sinks, bool flushAfter,
+                           std::shared_ptr<PriorityLatency> latency)
+    : level_(level), sinks_(std::move(sinks)), flushAfter_(flushAfter), latency_(std::move(latency)) {}
+
+void PriorityLane::log(const spdlog::details::log_msg& msg) {
+    sinks_->log(msg);
+    if (flushAfter_) {
+        sinks_->flush();
+    }
+    if (latency_) {
+        latency_->record(msg.time);
+    }
+}
+
+} // namespace Logging
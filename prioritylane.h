@@ -0,0 +1,53 @@
+#pragma once
+#include <spdlog/sinks/sink.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace Logging {
+
+// Time from a priority record being logged to its sink having flushed it
+class PriorityLatency {
+public:
+    struct Snapshot {
+        uint64_t count = 0;
+        std::chrono::nanoseconds last{0};
+        std::chrono::nanoseconds max{0};
+        std::chrono::nanoseconds mean{0};
+    };
+
+    void record(spdlog::log_clock::time_point logged);
+    Snapshot snapshot() const;
+
+private:
+    std::atomic<uint64_t> count_{0};
+    std::atomic<int64_t> totalNs_{0};
+    std::atomic<int64_t> lastNs_{0};
+    std::atomic<int64_t> maxNs_{0};
+};
+
+// Carries records at or above a level past the async queue: they are handed to
+// the sinks on the logging thread, where per-sink queues put them in front of
+// everything else. Without per-sink queues they are written, and with flushAfter
+// flushed, right away. Priority records can thus appear in a sink ahead of
+// lower-level records logged before them.
+class PriorityLane {
+public:
+    PriorityLane(spdlog::level::level_enum level, spdlog::sink_ptr sinks, bool flushAfter,
+                 std::shared_ptr<PriorityLatency> latency);
+
+    bool accepts(spdlog::level::level_enum level) const {
+        return level >= level_;
+    }
+
+    void log(const spdlog::details::log_msg& msg);
+
+private:
+    spdlog::level::level_enum level_;
+    spdlog::sink_ptr sinks_;
+    bool flushAfter_;
+    std::shared_ptr<PriorityLatency> latency_; // Set when the sinks write synchronously
+};
+
+} // namespace Logging
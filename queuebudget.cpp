@@ -0,0 +1,71 @@
+#include "queuebudget.h"
+#include <algorithm>
+
+namespace Logging {
+
+namespace {
+
+// How long a blocked producer sleeps before re-checking the budget
+constexpr std::chrono::milliseconds kBudgetWait{100};
+
+} // namespace
+
+QueueBudget::QueueBudget(size_t limitBytes, size_t reservePercent)
+    : limit_(std::max<size_t>(limitBytes, 1)),
+      admitLimit_(limit_ - limit_ * std::min<size_t>(reservePercent, 100) / 100) {}
+
+spdlog::details::log_msg QueueBudget::fit(const spdlog::details::log_msg& msg) const {
+    spdlog::details::log_msg queued = msg;
+    if (queued.payload.size() > limit_) {
+        queued.payload = spdlog::string_view_t(queued.payload.data(), limit_);
+    }
+    return queued;
+}
+
+bool QueueBudget::tryAcquire(size_t bytes, bool reserved) {
+    return tryAcquire(bytes, reserved ? limit_ : admitLimit_);
+}
+
+bool QueueBudget::tryAcquire(size_t bytes, size_t limit) {
+    size_t current = bytes_.load(std::memory_order_relaxed);
+    do {
+        if (current + bytes > limit) {
+            return false;
+        }
+    } while (!bytes_.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed));
+    records_.fetch_add(1, std::memory_order_relaxed);
+
+    size_t peak = peakBytes_.load(std::memory_order_relaxed);
+    while (current + bytes > peak &&
+           !peakBytes_.compare_exchange_weak(peak, current + bytes, std::memory_order_relaxed)) {
+    }
+    return true;
+}
+
+void QueueBudget::acquire(size_t bytes) {
+    while (!tryAcquire(bytes, limit_)) {
+        uint32_t key = released_.prepareWait();
+        if (tryAcquire(bytes, limit_)) {
+            released_.cancelWait();
+            return;
+        }
+        released_.wait(key, kBudgetWait);
+    }
+}
+
+void QueueBudget::release(size_t bytes) {
+    bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+    records_.fetch_sub(1, std::memory_order_relaxed);
+    released_.notifyAll();
+}
+
+QueueBudget::Gauge QueueBudget::gauge() const {
+    Gauge gauge;
+    gauge.bytes = bytes_.load(std::memory_order_relaxed);
+    gauge.records = records_.load(std::memory_order_relaxed);
+    gauge.peakBytes = peakBytes_.load(std::memory_order_relaxed);
+    gauge.limitBytes = limit_;
+    return gauge;
+}
+
+} // namespace Logging
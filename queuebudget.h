@@ -0,0 +1,75 @@
+#pragma once
+#include "eventcount.h"
+#include <spdlog/details/log_msg.h>
+#include <spdlog/sinks/sink.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace Logging {
+
+// Bound on the payload bytes held by an async queue. Producers acquire a record's
+// payload size before queueing it and the worker releases it once it has taken
+// the record, so queued memory stays below the limit whatever the message sizes,
+// while the queue's slots stay a fixed, preallocated slab. Like the slot reserve
+// of LevelOverflowGuard, droppable records may only fill the budget up to its
+// reserve.
+class QueueBudget {
+public:
+    struct Gauge {
+        uint64_t bytes = 0;     // Payload bytes queued right now
+        uint64_t records = 0;   // Records queued right now
+        uint64_t peakBytes = 0; // Highest bytes seen since start
+        uint64_t limitBytes = 0;
+    };
+
+    QueueBudget(size_t limitBytes, size_t reservePercent);
+
+    // The record as queued: payloads longer than the whole budget are cut short,
+    // so that any record fits once the queue has drained
+    spdlog::details::log_msg fit(const spdlog::details::log_msg& msg) const;
+
+    // Take bytes if they fit; reserved records may use the reserve
+    bool tryAcquire(size_t bytes, bool reserved);
+
+    // Take bytes, waiting for the worker to release enough
+    void acquire(size_t bytes);
+
+    void release(size_t bytes);
+
+    size_t limit() const { return limit_; }
+
+    Gauge gauge() const;
+
+private:
+    bool tryAcquire(size_t bytes, size_t limit);
+
+    const size_t limit_;
+    const size_t admitLimit_; // Limit for records that may not use the reserve
+
+    std::atomic<size_t> bytes_{0};
+    std::atomic<size_t> records_{0};
+    std::atomic<size_t> peakBytes_{0};
+    EventCount released_; // Blocked producers wait here
+};
+
+// Last sink of spdlog's async logger: gives a delivered record's bytes back to
+// the budget its producer acquired them from
+class BudgetReleaseSink : public spdlog::sinks::sink {
+public:
+    explicit BudgetReleaseSink(std::shared_ptr<QueueBudget> budget) : budget_(std::move(budget)) {
+        set_level(spdlog::level::trace);
+    }
+
+    void log(const spdlog::details::log_msg& msg) override {
+        budget_->release(msg.payload.size());
+    }
+    void flush() override {}
+    void set_pattern(const std::string&) override {}
+    void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+private:
+    std::shared_ptr<QueueBudget> budget_;
+};
+
+} // namespace Logging
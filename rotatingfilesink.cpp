@@ -0,0 +1,329 @@
+#include "rotatingfilesink.h"
+#include "threadtuning.h"
+#include <spdlog/common.h>
+#include <spdlog/pattern_formatter.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <tuple>
+#include <vector>
+#include <zlib.h>
+
+namespace Logging {
+
+namespace {
+
+constexpr char kCompressedSuffix[] = ".gz";
+constexpr char kTempSuffix[] = ".tmp";
+constexpr char kManifestSuffix[] = ".archives";
+constexpr size_t kCompressChunk = 64 * 1024;
+
+struct Archive {
+    uint64_t sequence;
+    std::filesystem::path path;
+    uintmax_t size;
+    bool compressed;
+};
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Archives of stem/extension in their directory, oldest first
+std::vector<Archive> findArchives(const std::string& stem, const std::string& extension) {
+    std::filesystem::path stemPath(stem);
+    std::filesystem::path dir = stemPath.parent_path().empty() ? "." : stemPath.parent_path();
+    std::string prefix = stemPath.filename().string() + ".";
+
+    std::vector<Archive> archives;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        bool compressed = endsWith(name, kCompressedSuffix);
+        std::string rest = compressed ? name.substr(0, name.size() - (sizeof(kCompressedSuffix) - 1)) : name;
+        if (rest.compare(0, prefix.size(), prefix) != 0 || !endsWith(rest, extension)) {
+            continue;
+        }
+        std::string digits = rest.substr(prefix.size(), rest.size() - prefix.size() - extension.size());
+        if (digits.empty() || !std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            continue;
+        }
+        std::error_code sizeEc;
+        uintmax_t size = entry.file_size(sizeEc);
+        if (sizeEc) {
+            continue; // Removed while we were looking
+        }
+        archives.push_back(Archive{std::stoull(digits), entry.path(), size, compressed});
+    }
+    std::sort(archives.begin(), archives.end(), [](const Archive& a, const Archive& b) {
+        return a.sequence < b.sequence || (a.sequence == b.sequence && a.compressed < b.compressed);
+    });
+    return archives;
+}
+
+} // namespace
+
+FileHousekeeper::FileHousekeeper(const std::string& baseFilename, RotationOptions options)
+    : options_(options), manifest_(baseFilename + kManifestSuffix) {
+    std::tie(stem_, extension_) = spdlog::details::file_helper::split_by_extension(baseFilename);
+    loadManifest();
+    // Past every file of archive shape, so a rotation never renames over one
+    auto archives = findArchives(stem_, extension_);
+    if (!archives.empty()) {
+        nextSequence_ = archives.back().sequence + 1;
+    }
+    if (!owned_.empty()) {
+        nextSequence_ = std::max(nextSequence_, *owned_.rbegin() + 1);
+    }
+    // A compression cut short by a crash leaves its temporary file behind
+    for (uint64_t sequence : owned_) {
+        std::error_code ec;
+        std::filesystem::remove(archiveName(sequence) + kCompressedSuffix + kTempSuffix, ec);
+    }
+    thread_ = std::thread([this]() { run(); });
+}
+
+FileHousekeeper::~FileHousekeeper() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+std::string FileHousekeeper::archiveName(uint64_t sequence) const {
+    return stem_ + "." + std::to_string(sequence) + extension_;
+}
+
+void FileHousekeeper::archived(uint64_t sequence) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rotated_.push_back(sequence);
+        pending_ = true;
+    }
+    cv_.notify_one();
+}
+
+void FileHousekeeper::run() {
+    tuneCurrentThread("housekeep");
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this]() { return pending_ || stop_; });
+        std::vector<uint64_t> rotated;
+        rotated.swap(rotated_);
+        bool stop = stop_;
+        pending_ = false;
+        lock.unlock();
+        if (!rotated.empty()) {
+            owned_.insert(rotated.begin(), rotated.end());
+            saveManifest();
+        }
+        if (stop) {
+            // Uncompressed archives left behind are picked up by the next run
+            return;
+        }
+        // Retention is re-checked before every compression, so a burst of
+        // rotations cannot pile up segments while a large one is compressed
+        while (housekeep()) {
+            std::lock_guard<std::mutex> stopLock(mutex_);
+            if (stop_) {
+                return;
+            }
+        }
+        lock.lock();
+    }
+}
+
+bool FileHousekeeper::housekeep() {
+    // Leave alone what this logger did not write, and forget its archives that
+    // were removed by hand
+    auto archives = findArchives(stem_, extension_);
+    archives.erase(std::remove_if(archives.begin(), archives.end(),
+                                  [this](const Archive& archive) { return owned_.count(archive.sequence) == 0; }),
+                   archives.end());
+    std::set<uint64_t> present;
+    for (const auto& archive : archives) {
+        present.insert(archive.sequence);
+    }
+    bool changed = present != owned_;
+    owned_ = std::move(present);
+
+    // Deduplicate: a crash during compression can leave both forms of a segment
+    for (size_t i = 1; i < archives.size();) {
+        if (archives[i].sequence == archives[i - 1].sequence) {
+            // Sorted uncompressed first; the .gz may be incomplete, keep the original
+            std::error_code ec;
+            std::filesystem::remove(archives[i].path, ec);
+            archives.erase(archives.begin() + static_cast<std::ptrdiff_t>(i));
+        } else {
+            ++i;
+        }
+    }
+
+    size_t keep = options_.maxFiles;
+    uintmax_t total = options_.maxFileSize; // Room for the active file
+    for (const auto& archive : archives) {
+        total += archive.size;
+    }
+    size_t first = 0;
+    while (first < archives.size() &&
+           (archives.size() - first > keep || (options_.maxTotalBytes > 0 && total > options_.maxTotalBytes))) {
+        std::error_code ec;
+        std::filesystem::remove(archives[first].path, ec);
+        owned_.erase(archives[first].sequence);
+        changed = true;
+        total -= archives[first].size;
+        ++first;
+    }
+    if (changed) {
+        saveManifest();
+    }
+
+    if (!options_.compress) {
+        return false;
+    }
+    for (size_t i = first; i < archives.size(); ++i) {
+        if (!archives[i].compressed) {
+            std::string source = archives[i].path.string();
+            std::string target = source + kCompressedSuffix;
+            if (compressFile(source, target)) {
+                std::error_code ec;
+                std::filesystem::remove(source, ec);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FileHousekeeper::compressFile(const std::string& source, const std::string& target) {
+    std::FILE* in = std::fopen(source.c_str(), "rb");
+    if (!in) {
+        return false;
+    }
+    // Write under a temporary name so a partial .gz is never mistaken for an archive
+    std::string temp = target + kTempSuffix;
+    gzFile out = gzopen(temp.c_str(), "wb");
+    if (!out) {
+        std::fclose(in);
+        return false;
+    }
+    std::vector<char> buffer(kCompressChunk);
+    bool ok = true;
+    size_t read;
+    while ((read = std::fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+        if (gzwrite(out, buffer.data(), static_cast<unsigned>(read)) != static_cast<int>(read)) {
+            ok = false;
+            break;
+        }
+    }
+    ok = !std::ferror(in) && ok;
+    std::fclose(in);
+    ok = gzclose(out) == Z_OK && ok;
+
+    std::error_code ec;
+    if (ok) {
+        std::filesystem::rename(temp, target, ec);
+    }
+    if (!ok || ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+void FileHousekeeper::loadManifest() {
+    std::ifstream in(manifest_);
+    uint64_t sequence;
+    while (in >> sequence) {
+        owned_.insert(sequence);
+    }
+}
+
+void FileHousekeeper::saveManifest() {
+    // Replaced with a rename, so a crash leaves either the old list or the new one
+    std::string temp = manifest_ + kTempSuffix;
+    std::error_code ec;
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        for (uint64_t sequence : owned_) {
+            out << sequence << '\n';
+        }
+        if (!out.flush()) {
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(temp, manifest_, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+    }
+}
+
+RotatingFileSink::RotatingFileSink(const std::string& filename, RotationOptions options,
+                                   const spdlog::file_event_handlers& handlers)
+    : options_(options), formatter_(std::make_unique<spdlog::pattern_formatter>()), file_(handlers),
+      housekeeper_(std::make_unique<FileHousekeeper>(filename, options)), nextSequence_(housekeeper_->nextSequence()) {
+    file_.open(filename);
+    currentSize_ = file_.size();
+}
+
+void RotatingFileSink::log(const spdlog::details::log_msg& msg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    formatted_.clear();
+    formatter_->format(msg, formatted_);
+    write(formatted_);
+}
+
+void RotatingFileSink::logFormatted(const spdlog::details::log_msg&, const FormattedRecordPtr& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    write(record->text);
+}
+
+void RotatingFileSink::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_.flush();
+}
+
+void RotatingFileSink::set_pattern(const std::string& pattern) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    formatter_ = std::make_unique<spdlog::pattern_formatter>(pattern);
+}
+
+void RotatingFileSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    formatter_ = std::move(sink_formatter);
+}
+
+void RotatingFileSink::write(const spdlog::memory_buf_t& text) {
+    size_t newSize = currentSize_ + text.size();
+    if (newSize > options_.maxFileSize && currentSize_ > 0) {
+        rotate();
+        newSize = text.size();
+    }
+    file_.write(text);
+    currentSize_ = newSize;
+}
+
+void RotatingFileSink::rotate() {
+    // The only disk work on the logging thread: close, one rename, reopen
+    std::string filename = file_.filename();
+    uint64_t sequence = nextSequence_++;
+    std::string archive = housekeeper_->archiveName(sequence);
+    file_.close();
+    if (std::rename(filename.c_str(), archive.c_str()) != 0) {
+        int error = errno; // Before the reopen can overwrite it
+        file_.reopen(true); // Truncate anyway so the file cannot outgrow its limit
+        currentSize_ = 0;
+        spdlog::throw_spdlog_ex("RotatingFileSink: failed renaming " + filename + " to " + archive, error);
+    }
+    file_.reopen(true);
+    currentSize_ = 0;
+    housekeeper_->archived(sequence);
+}
+
+} // namespace Logging
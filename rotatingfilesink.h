@@ -0,0 +1,99 @@
+#pragma once
+#include "formattedsink.h"
+#include <spdlog/details/file_helper.h>
+#include <spdlog/formatter.h>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Logging {
+
+// Size and retention limits of a rotating log file
+struct RotationOptions {
+    size_t maxFileSize = 1024 * 1024; // Rotate once the active file reaches this size
+    size_t maxFiles = 3;              // Archives to keep besides the active file
+    size_t maxTotalBytes = 0;         // Budget for active file and archives together, 0 disables
+    bool compress = true;             // gzip archives in the background
+};
+
+// Enforces retention on the archives of one log file and compresses them, on its
+// own thread so the logging thread never waits for the disk.
+//
+// Archives are named <stem>.<seq><ext>, or <stem>.<seq><ext>.gz once compressed,
+// with seq growing with every rotation; the oldest archives are deleted first.
+// Only archives listed in the manifest, <filename>.archives, are ever deleted or
+// compressed, so files of the same shape that this logger did not write survive.
+class FileHousekeeper {
+public:
+    FileHousekeeper(const std::string& baseFilename, RotationOptions options);
+    ~FileHousekeeper();
+
+    FileHousekeeper(const FileHousekeeper&) = delete;
+    FileHousekeeper& operator=(const FileHousekeeper&) = delete;
+
+    // Sequence number for the next archive, continuing after those already on disk
+    uint64_t nextSequence() const {
+        return nextSequence_;
+    }
+
+    std::string archiveName(uint64_t sequence) const;
+
+    // Record the archive a rotation just renamed and wake the thread
+    void archived(uint64_t sequence);
+
+private:
+    void run();
+    // One retention pass; returns false when nothing is left to compress
+    bool housekeep();
+    bool compressFile(const std::string& source, const std::string& target);
+    void loadManifest();
+    void saveManifest();
+
+    std::string stem_;
+    std::string extension_;
+    RotationOptions options_;
+    uint64_t nextSequence_ = 1;
+    std::string manifest_;
+    std::set<uint64_t> owned_; // Sequences this logger archived; housekeeper thread after construction
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool pending_ = true; // Tidy up leftovers of the previous run on start
+    std::vector<uint64_t> rotated_; // Archived since the last pass
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+// Rotating file sink whose rotation is a single rename on the logging thread;
+// compression and deletion of old segments are left to a FileHousekeeper.
+class RotatingFileSink : public FormattedSink {
+public:
+    RotatingFileSink(const std::string& filename, RotationOptions options,
+                     const spdlog::file_event_handlers& handlers = {});
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void logFormatted(const spdlog::details::log_msg& msg, const FormattedRecordPtr& record) override;
+    void flush() override;
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+private:
+    void write(const spdlog::memory_buf_t& text);
+    void rotate();
+
+    RotationOptions options_;
+    std::mutex mutex_;
+    std::unique_ptr<spdlog::formatter> formatter_;
+    spdlog::memory_buf_t formatted_; // Reused by log()
+    spdlog::details::file_helper file_;
+    size_t currentSize_ = 0;
+    std::unique_ptr<FileHousekeeper> housekeeper_;
+    uint64_t nextSequence_;
+};
+
+} // namespace Logging
@@ -0,0 +1,138 @@
+#pragma once
+#include "logclock.h"
+#include "loggerfacade.h"
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+namespace Logging {
+
+// Per-call-site samplers for the LOGIX_LOG_EVERY_N, LOGIX_LOG_RATE and
+// LOGIX_LOG_FIRST_N macros. Each keeps its state in its own atomics, so a
+// rejected occurrence never reaches the logger or its queue. admit() reports
+// how many occurrences were rejected since the site last logged.
+
+// Admits the 1st, (n+1)th, (2n+1)th ... occurrence
+class EveryN {
+public:
+    explicit constexpr EveryN(uint64_t n) : n_(n > 0 ? n : 1) {}
+
+    bool admit(uint64_t& suppressed) {
+        uint64_t count = count_.fetch_add(1, std::memory_order_relaxed);
+        if (count % n_ != 0) {
+            return false;
+        }
+        suppressed = count == 0 ? 0 : n_ - 1;
+        return true;
+    }
+
+private:
+    const uint64_t n_;
+    std::atomic<uint64_t> count_{0};
+};
+
+// Admits at most perSecond occurrences per wall-clock second
+class RateLimit {
+public:
+    static constexpr uint64_t kMaxPerSecond = (1u << 24) - 1;
+
+    explicit constexpr RateLimit(uint64_t perSecond)
+        : perSecond_(perSecond < kMaxPerSecond ? perSecond : kMaxPerSecond) {}
+
+    bool admit(uint64_t& suppressed) {
+        // A coarse read is enough to tell seconds apart
+        auto second = static_cast<uint64_t>(LogClock::coarseNanos() / 1000000000);
+        uint64_t state = state_.load(std::memory_order_relaxed);
+        for (;;) {
+            uint64_t next;
+            if (state >> kCountBits != second) {
+                next = second << kCountBits | 1;
+            } else if ((state & kMaxPerSecond) >= perSecond_) {
+                suppressed_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                next = state + 1;
+            }
+            if (state_.compare_exchange_weak(state, next, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    static constexpr int kCountBits = 24;
+
+    const uint64_t perSecond_;
+    std::atomic<uint64_t> state_{0}; // Second << kCountBits | occurrences admitted in it
+    std::atomic<uint64_t> suppressed_{0};
+};
+
+// Admits the first n occurrences, then nothing
+class FirstN {
+public:
+    explicit constexpr FirstN(uint64_t n) : n_(n) {}
+
+    bool admit(uint64_t& suppressed) {
+        // Once silent, stay read-only so busy sites do not bounce the cache line
+        if (count_.load(std::memory_order_relaxed) >= n_) {
+            return false;
+        }
+        suppressed = 0;
+        return count_.fetch_add(1, std::memory_order_relaxed) < n_;
+    }
+
+private:
+    const uint64_t n_;
+    std::atomic<uint64_t> count_{0};
+};
+
+// Log through the facade's logger, noting the occurrences a sampler suppressed
+template <typename... Args>
+void logSampled(spdlog::source_loc loc, spdlog::level::level_enum level, uint64_t suppressed,
+                spdlog::format_string_t<Args...> format, Args&&... args) {
+    spdlog::logger* logger = LoggerFacade::getInstance().activeLogger();
+    if (!logger) {
+        return;
+    }
+    if (suppressed == 0) {
+        logStamped(*logger, loc, level, format, std::forward<Args>(args)...);
+        return;
+    }
+    spdlog::log_clock::time_point time = LogClock::now();
+    spdlog::memory_buf_t buf;
+    fmt::format_to(std::back_inserter(buf), format, std::forward<Args>(args)...);
+    fmt::format_to(std::back_inserter(buf), " (suppressed {})", suppressed);
+    logger->log(time, loc, level, spdlog::string_view_t(buf.data(), buf.size()));
+}
+
+} // namespace Logging
+
+// Sampled logging macros. level and the sampler argument must be constants; each
+// call site keeps its own sampler. The level is checked first, so occurrences at
+// a disabled level are neither counted nor evaluated, and levels below
+// LOGIX_ACTIVE_LEVEL are compiled away.
+#define LOGIX_LOG_SAMPLED(sampler, level, ...)                                                              \
+    do {                                                                                                    \
+        if (static_cast<int>(level) >= LOGIX_ACTIVE_LEVEL) {                                                \
+            static ::Logging::LevelGate logixGate_(level);                                                  \
+            static sampler;                                                                                 \
+            uint64_t logixSuppressed_ = 0;                                                                  \
+            if (logixGate_.enabled() && logixSampler_.admit(logixSuppressed_)) {                            \
+                ::Logging::logSampled(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, level,       \
+                                      logixSuppressed_, __VA_ARGS__);                                       \
+            }                                                                                               \
+        }                                                                                                   \
+    } while (0)
+
+// Every nth occurrence, starting with the first
+#define LOGIX_LOG_EVERY_N(level, n, ...) LOGIX_LOG_SAMPLED(::Logging::EveryN logixSampler_(n), level, __VA_ARGS__)
+
+// At most perSecond occurrences per second
+#define LOGIX_LOG_RATE(level, perSecond, ...)                                                               \
+    LOGIX_LOG_SAMPLED(::Logging::RateLimit logixSampler_(perSecond), level, __VA_ARGS__)
+
+// The first n occurrences only
+#define LOGIX_LOG_FIRST_N(level, n, ...) LOGIX_LOG_SAMPLED(::Logging::FirstN logixSampler_(n), level, __VA_ARGS__)
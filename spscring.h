@@ -0,0 +1,74 @@
+#pragma once
+#include "mpscring.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace Logging {
+
+// Bounded single-producer/single-consumer ring. The producer and the consumer
+// each own one index on a separate cache line and keep a cached copy of the
+// other's, so in steady state neither touches a line the other writes.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+        : capacity_(roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity)),
+          mask_(capacity_ - 1),
+          slots_(new T[capacity_]) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer only: let fill(T&) write the next slot; false when the ring is full
+    template <typename Fill>
+    bool tryPush(Fill&& fill) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cachedTail_ >= capacity_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head - cachedTail_ >= capacity_) {
+                return false;
+            }
+        }
+        fill(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only: the oldest value, or nullptr when empty
+    T* front() {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cachedHead_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail == cachedHead_) {
+                return nullptr;
+            }
+        }
+        return &slots_[tail & mask_];
+    }
+
+    // Consumer only: release the slot returned by front()
+    void popFront() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Approximate when the other side is active
+    size_t size() const {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+    alignas(kCacheLineSize) std::atomic<size_t> head_{0}; // Written by the producer
+    size_t cachedTail_ = 0;                               // Producer's view of tail_
+    alignas(kCacheLineSize) std::atomic<size_t> tail_{0}; // Written by the consumer
+    size_t cachedHead_ = 0;                               // Consumer's view of head_
+};
+
+} // namespace Logging
@@ -0,0 +1,356 @@
+#include "spscstaging.h"
+#include "logclock.h"
+#include <spdlog/details/os.h>
+#include <algorithm>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+namespace Logging {
+
+struct SpscRecordQueue::ThreadStage {
+    ThreadStage(size_t capacity, std::shared_ptr<PayloadPool> payloadPool)
+        : pool(std::move(payloadPool)), ring(capacity) {}
+
+    std::shared_ptr<PayloadPool> pool; // The thread may outlive the queue, and the slots need it
+    SpscRing<AsyncRecord> ring;
+    std::atomic<bool> retired{false};   // Set by the owning thread on exit
+    std::atomic<size_t> dropped{0};     // Written by the owning thread only
+    size_t reportedDropped = 0;         // Collector side
+    bool queued = false;                // In the collector's heap
+    EventCount notFull;                 // The owning thread waits here for room
+    size_t threadId = 0;
+    std::string threadName;
+};
+
+namespace {
+
+std::atomic<uint64_t> nextQueueId{1};
+
+// Spins before a producer facing its own full ring goes to sleep
+constexpr int kFullRingSpins = 64;
+constexpr std::chrono::milliseconds kFullRingWait{10};
+
+// The calling thread's staging ring; retired when the thread exits
+struct LocalStageHandle {
+    uint64_t queueId = 0;
+    std::shared_ptr<SpscRecordQueue::ThreadStage> stage;
+
+    ~LocalStageHandle();
+};
+
+thread_local LocalStageHandle localHandle;
+
+std::string currentThreadName() {
+#ifdef __linux__
+    char name[16] = {};
+    if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0) {
+        return name;
+    }
+#endif
+    return {};
+}
+
+// Heap order of the collector's rings: the earliest front record on top
+struct EarliestFirst {
+    template <typename Entry>
+    bool operator()(const Entry& a, const Entry& b) const {
+        return a.time > b.time;
+    }
+};
+
+AsyncRecord makeReport(const std::string& text) {
+    AsyncRecord rec;
+    rec.kind = AsyncRecord::Kind::Log;
+    rec.msg.assign(spdlog::details::log_msg("logix", spdlog::level::warn, text), nullptr);
+    return rec;
+}
+
+} // namespace
+
+LocalStageHandle::~LocalStageHandle() {
+    if (stage) {
+        stage->retired.store(true, std::memory_order_release);
+    }
+}
+
+SpscRecordQueue::SpscRecordQueue(size_t perThreadCapacity, std::shared_ptr<PayloadPool> pool)
+    : id_(nextQueueId.fetch_add(1, std::memory_order_relaxed)),
+      perThreadCapacity_(perThreadCapacity),
+      pool_(std::move(pool)) {}
+
+SpscRecordQueue::~SpscRecordQueue() {
+    StageChunk* chunk = directory_.next.load(std::memory_order_relaxed);
+    while (chunk) {
+        StageChunk* next = chunk->next.load(std::memory_order_relaxed);
+        delete chunk;
+        chunk = next;
+    }
+}
+
+SpscRecordQueue::ThreadStage& SpscRecordQueue::localStage() {
+    if (localHandle.queueId == id_) {
+        return *localHandle.stage;
+    }
+    // First record from this thread (or from a previous queue's registration)
+    if (localHandle.stage) {
+        localHandle.stage->retired.store(true, std::memory_order_release);
+    }
+    std::shared_ptr<ThreadStage> stage;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        if (!freeStages_.empty()) {
+            // The collector drained it after its thread exited, and has let go of it
+            stage = std::move(freeStages_.back());
+            freeStages_.pop_back();
+            stage->dropped.store(0, std::memory_order_relaxed);
+            stage->reportedDropped = 0;
+            stage->retired.store(false, std::memory_order_relaxed);
+        } else {
+            stage = std::make_shared<ThreadStage>(perThreadCapacity_, pool_);
+            if (directoryTailUsed_ == StageChunk::kStages) {
+                auto* chunk = new StageChunk();
+                directoryTail_->next.store(chunk, std::memory_order_release);
+                directoryTail_ = chunk;
+                directoryTailUsed_ = 0;
+            }
+            directoryTail_->stages[directoryTailUsed_++].store(stage.get(), std::memory_order_release);
+        }
+        stage->threadId = spdlog::details::os::thread_id();
+        stage->threadName = currentThreadName();
+        registry_.push_back(stage);
+        registryVersion_.fetch_add(1, std::memory_order_release);
+    }
+    localHandle.queueId = id_;
+    localHandle.stage = std::move(stage);
+    return *localHandle.stage;
+}
+
+template <typename Fill>
+bool SpscRecordQueue::pushToStage(ThreadStage& stage, Fill&& fill, bool block) {
+    if (stage.ring.tryPush(fill)) {
+        return true;
+    }
+    if (!block) {
+        // Only this thread writes its counter, no read-modify-write needed
+        stage.dropped.store(stage.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+    for (int spin = 0; spin < kFullRingSpins; ++spin) {
+        std::this_thread::yield();
+        if (stage.ring.tryPush(fill)) {
+            return true;
+        }
+    }
+    for (;;) {
+        uint32_t key = stage.notFull.prepareWait();
+        if (stage.ring.tryPush(fill)) {
+            stage.notFull.cancelWait();
+            return true;
+        }
+        notEmpty_.notifyOne(); // Make sure the collector is awake to make room
+        stage.notFull.wait(key, kFullRingWait);
+    }
+}
+
+bool SpscRecordQueue::push(const spdlog::details::log_msg& msg, spdlog::async_overflow_policy policy) {
+    auto fill = [this, &msg](AsyncRecord& rec) {
+        rec.kind = AsyncRecord::Kind::Log;
+        rec.msg.assign(msg, pool_.get());
+        rec.budgeted = true;
+    };
+    if (!pushToStage(localStage(), fill, policy == spdlog::async_overflow_policy::block)) {
+        return false;
+    }
+    notEmpty_.notifyOne();
+    return true;
+}
+
+void SpscRecordQueue::pushControl(AsyncRecord::Kind kind) {
+    // Markers need no ring of the calling thread: flushing or changing the level
+    // from many threads must not register a stage for each of them
+    AsyncRecord rec;
+    rec.kind = kind;
+    rec.budgeted = false;
+    rec.msg.reset();
+    rec.msg.msg().time = spdlog::details::os::now(); // Merged with the records around it
+    {
+        std::lock_guard<std::mutex> lock(controlMutex_);
+        controls_.push_back(std::move(rec));
+    }
+    pendingControls_.fetch_add(1, std::memory_order_release);
+    notEmpty_.notifyOne();
+}
+
+bool SpscRecordQueue::pop(AsyncRecord& out, std::chrono::milliseconds timeout) {
+    if (!tryPopMerged(out)) {
+        uint32_t key = notEmpty_.prepareWait();
+        if (tryPopMerged(out)) {
+            notEmpty_.cancelWait();
+        } else {
+            notEmpty_.wait(key, timeout);
+            if (!tryPopMerged(out)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+size_t SpscRecordQueue::size() const {
+    // Stages waiting to be recycled are empty and add nothing
+    size_t total = 0;
+    for (const StageChunk* chunk = &directory_; chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
+        for (const auto& slot : chunk->stages) {
+            const ThreadStage* stage = slot.load(std::memory_order_acquire);
+            if (!stage) {
+                return total;
+            }
+            total += stage->ring.size();
+        }
+    }
+    return total;
+}
+
+size_t SpscRecordQueue::localSize() const {
+    return localHandle.queueId == id_ ? localHandle.stage->ring.size() : 0;
+}
+
+size_t SpscRecordQueue::dropped() const {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    size_t total = retiredDropped_.load(std::memory_order_relaxed);
+    for (const auto& stage : registry_) {
+        total += stage->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+bool SpscRecordQueue::tryPopMerged(AsyncRecord& out) {
+    if (!reports_.empty()) {
+        out = std::move(reports_.front());
+        reports_.pop_front();
+        return true;
+    }
+
+    // The oldest marker is looked at before the rings, so the records its thread
+    // pushed ahead of it are visible by then
+    const AsyncRecord* control = nullptr;
+    if (pendingControls_.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(controlMutex_);
+        control = &controls_.front(); // Stays in place while producers append
+    }
+
+    // Empty rings are checked again when nothing else is left, once per pass over
+    // all rings, for a new marker, and when threads come or go
+    if (heap_.empty() || popsSinceScan_ >= stages_.size() || (control && !controlScanned_) ||
+        registryVersion_.load(std::memory_order_relaxed) != seenVersion_) {
+        scanStages();
+        controlScanned_ = control != nullptr;
+    }
+    ThreadStage* earliest = heap_.empty() ? nullptr : heap_.front().stage;
+
+    if (control) {
+        if (control->kind == AsyncRecord::Kind::Stop) {
+            // Stop goes last, after every thread's queued records; an empty heap was just rescanned
+            if (!earliest) {
+                // Report drops of threads still alive before handing out the stop marker
+                for (const auto& stage : stages_) {
+                    queueDropReport(*stage, false);
+                }
+                if (!reports_.empty()) {
+                    return tryPopMerged(out);
+                }
+                return popControl(out);
+            }
+        } else if (!earliest || control->msg.msg().time < heap_.front().time) {
+            return popControl(out);
+        }
+    }
+    if (!earliest) {
+        return false;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), EarliestFirst());
+    heap_.pop_back();
+    earliest->queued = false;
+    out = std::move(*earliest->ring.front());
+    earliest->ring.popFront();
+    earliest->notFull.notifyOne(); // Only its own thread can be waiting for this room
+    if (const AsyncRecord* next = earliest->ring.front()) {
+        pushHeap(*earliest, *next);
+    }
+    ++popsSinceScan_;
+    return true;
+}
+
+bool SpscRecordQueue::popControl(AsyncRecord& out) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    out = std::move(controls_.front());
+    controls_.pop_front();
+    pendingControls_.fetch_sub(1, std::memory_order_relaxed);
+    controlScanned_ = false;
+    return true;
+}
+
+void SpscRecordQueue::refreshStages() {
+    uint64_t version = registryVersion_.load(std::memory_order_acquire);
+    if (version == seenVersion_) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    stages_ = registry_;
+    seenVersion_ = registryVersion_.load(std::memory_order_relaxed);
+}
+
+// Put the rings that have records but are not in the heap into it, and recycle
+// the drained rings of exited threads
+void SpscRecordQueue::scanStages() {
+    refreshStages();
+    popsSinceScan_ = 0;
+    std::vector<std::shared_ptr<ThreadStage>> reclaimed;
+    for (auto it = stages_.begin(); it != stages_.end();) {
+        ThreadStage& stage = **it;
+        if (!stage.queued) {
+            // retired is set after the thread's last push, so an empty ring stays empty
+            bool retired = stage.retired.load(std::memory_order_acquire);
+            if (const AsyncRecord* front = stage.ring.front()) {
+                pushHeap(stage, *front);
+            } else if (retired) {
+                queueDropReport(stage, true);
+                retiredDropped_.fetch_add(stage.dropped.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                reclaimed.push_back(std::move(*it));
+                it = stages_.erase(it);
+                continue;
+            }
+        }
+        ++it;
+    }
+    if (!reclaimed.empty()) {
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        registry_.erase(std::remove_if(registry_.begin(), registry_.end(), [&reclaimed](const auto& stage) {
+            return std::find(reclaimed.begin(), reclaimed.end(), stage) != reclaimed.end();
+        }), registry_.end());
+        freeStages_.insert(freeStages_.end(), reclaimed.begin(), reclaimed.end());
+    }
+}
+
+void SpscRecordQueue::pushHeap(ThreadStage& stage, const AsyncRecord& front) {
+    // LOGIX_* records may carry raw TSC ticks, compared here as wall time
+    heap_.push_back(HeapEntry{LogClock::resolve(front.msg.msg().time), &stage});
+    std::push_heap(heap_.begin(), heap_.end(), EarliestFirst());
+    stage.queued = true;
+}
+
+void SpscRecordQueue::queueDropReport(ThreadStage& stage, bool exited) {
+    size_t dropped = stage.dropped.load(std::memory_order_relaxed);
+    if (dropped == stage.reportedDropped) {
+        return;
+    }
+    std::string name = stage.threadName.empty() ? std::string() : " (" + stage.threadName + ")";
+    reports_.push_back(makeReport(fmt::format("Thread {}{} dropped {} log records{}", stage.threadId, name,
+                                              dropped - stage.reportedDropped,
+                                              exited ? " before exiting" : "")));
+    stage.reportedDropped = dropped;
+}
+
+} // namespace Logging
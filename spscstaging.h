@@ -0,0 +1,98 @@
+#pragma once
+#include "asyncpipeline.h"
+#include "spscring.h"
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace Logging {
+
+// Queue engine with one SPSC staging ring per producer thread. A thread's ring is
+// registered the first time it logs; after that its hot path writes only to memory
+// it owns. The single collector (the pipeline worker) merges the rings by record
+// timestamp through a min-heap of the non-empty rings, so a pop costs O(log n) in
+// the number of threads. Rings that were empty are looked at again once every n
+// pops, or as soon as the heap runs dry: order within a thread is always kept,
+// across threads records are ordered among those the collector has seen.
+//
+// A ring is retired when its thread exits and recycled for a new thread once the
+// collector has drained it. Threads that dropped records are reported with a
+// warning record when they exit and at shutdown.
+class SpscRecordQueue : public RecordQueue {
+public:
+    // pool, if given, holds payloads too large for a slot
+    SpscRecordQueue(size_t perThreadCapacity, std::shared_ptr<PayloadPool> pool);
+    ~SpscRecordQueue() override;
+
+    SpscRecordQueue(const SpscRecordQueue&) = delete;
+    SpscRecordQueue& operator=(const SpscRecordQueue&) = delete;
+
+    bool push(const spdlog::details::log_msg& msg, spdlog::async_overflow_policy policy) override;
+    void pushControl(AsyncRecord::Kind kind) override;
+    bool pop(AsyncRecord& out, std::chrono::milliseconds timeout) override;
+    // Lock-free, so the drain probe never waits for a registering thread
+    size_t size() const override;
+    size_t dropped() const override;
+    size_t capacity() const override { return perThreadCapacity_; }
+    bool sharedBound() const override { return false; }
+    size_t localSize() const override;
+
+    struct ThreadStage;
+
+private:
+    // Every stage the queue has created, readable without the registry lock.
+    // Slots are filled in order and never cleared; stages are recycled, not freed.
+    struct StageChunk {
+        static constexpr size_t kStages = 64;
+        std::atomic<ThreadStage*> stages[kStages] = {};
+        std::atomic<StageChunk*> next{nullptr};
+    };
+
+    // A non-empty ring in the collector's heap, keyed by its front record's time
+    struct HeapEntry {
+        spdlog::log_clock::time_point time;
+        ThreadStage* stage;
+    };
+
+    ThreadStage& localStage();
+    template <typename Fill>
+    bool pushToStage(ThreadStage& stage, Fill&& fill, bool block);
+
+    // Collector side
+    bool tryPopMerged(AsyncRecord& out);
+    bool popControl(AsyncRecord& out);
+    void refreshStages();
+    void scanStages();
+    void pushHeap(ThreadStage& stage, const AsyncRecord& front);
+    void queueDropReport(ThreadStage& stage, bool exited);
+
+    const uint64_t id_; // Tells this queue's thread-local registrations from older ones
+    const size_t perThreadCapacity_;
+    const std::shared_ptr<PayloadPool> pool_;
+
+    mutable std::mutex registryMutex_; // Taken on registration and reclamation only
+    std::vector<std::shared_ptr<ThreadStage>> registry_;
+    std::vector<std::shared_ptr<ThreadStage>> freeStages_; // Drained stages of exited threads
+    std::atomic<uint64_t> registryVersion_{0};
+    StageChunk directory_;
+    StageChunk* directoryTail_ = &directory_; // Guarded by registryMutex_
+    size_t directoryTailUsed_ = 0;
+    std::atomic<size_t> retiredDropped_{0};
+
+    // Flush and stop markers, merged with the rings by time; stop goes last
+    std::mutex controlMutex_;
+    std::deque<AsyncRecord> controls_;
+    std::atomic<size_t> pendingControls_{0};
+
+    // Owned by the collector thread
+    std::vector<std::shared_ptr<ThreadStage>> stages_;
+    uint64_t seenVersion_ = 0;
+    std::vector<HeapEntry> heap_;
+    size_t popsSinceScan_ = 0;
+    bool controlScanned_ = false; // The rings were scanned since the oldest marker arrived
+    std::deque<AsyncRecord> reports_;
+
+    EventCount notEmpty_;
+};
+
+} // namespace Logging
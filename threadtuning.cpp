@@ -0,0 +1,111 @@
+#include "threadtuning.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Logging {
+
+namespace {
+
+// Longest name pthread_setname_np accepts, without the terminator
+constexpr size_t kMaxThreadName = 15;
+
+std::mutex tuningMutex;
+ThreadTuning currentTuning;
+
+void reportFailure(const std::string& name, const char* what, int error) {
+    std::fprintf(stderr, "[*** LOG ERROR ***] [%s] cannot set %s: %s\n", name.c_str(), what, std::strerror(error));
+}
+
+} // namespace
+
+bool parseCpuList(const std::string& text, std::vector<int>& cpus) {
+    std::vector<int> parsed;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string item = text.substr(pos, end - pos);
+        pos = end + 1;
+        int first;
+        int last;
+        char dash;
+        char extra;
+        int matched = std::sscanf(item.c_str(), "%d %c %d %c", &first, &dash, &last, &extra);
+        if (matched == 1) {
+            last = first;
+        } else if (matched != 3 || dash != '-') {
+            return false;
+        }
+        if (first < 0 || last < first) {
+            return false;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            parsed.push_back(cpu);
+        }
+    }
+    if (parsed.empty()) {
+        return false;
+    }
+    cpus = std::move(parsed);
+    return true;
+}
+
+void setThreadTuning(ThreadTuning tuning) {
+    std::lock_guard<std::mutex> lock(tuningMutex);
+    currentTuning = std::move(tuning);
+}
+
+void tuneCurrentThread(const std::string& role) {
+    ThreadTuning tuning;
+    {
+        std::lock_guard<std::mutex> lock(tuningMutex);
+        tuning = currentTuning;
+    }
+    std::string name = tuning.namePrefix.empty() ? role : tuning.namePrefix + "-" + role;
+    name.resize(std::min(name.size(), kMaxThreadName));
+#ifdef __linux__
+    pthread_setname_np(pthread_self(), name.c_str());
+
+    if (!tuning.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : tuning.cpus) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (error != 0) {
+            reportFailure(name, "CPU affinity", error);
+        }
+    }
+    if (tuning.idle) {
+        sched_param param{};
+        int error = pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+        if (error != 0) {
+            reportFailure(name, "SCHED_IDLE", error);
+        }
+    }
+    // On Linux the nice value is a property of the thread, not the process
+    if (tuning.setNice &&
+        setpriority(PRIO_PROCESS, static_cast<id_t>(::syscall(SYS_gettid)), tuning.nice) != 0) {
+        reportFailure(name, "nice value", errno);
+    }
+#else
+    (void)name;
+#endif
+}
+
+} // namespace Logging
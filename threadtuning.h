@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace Logging {
+
+// Placement and scheduling of the library's background threads: queue workers,
+// sink workers, the flusher, file housekeeping and the binary log writer
+struct ThreadTuning {
+    std::vector<int> cpus;          // CPUs the threads may run on, empty leaves affinity alone
+    bool setNice = false;
+    int nice = 0;                   // Applied per thread when setNice
+    bool idle = false;              // SCHED_IDLE: run only when a CPU has nothing else to do
+    std::string namePrefix = "logix"; // Threads are named <prefix>-<role>, cut to 15 characters
+};
+
+// Parse a CPU list like "0-3,8,10-11"; false on malformed input
+bool parseCpuList(const std::string& text, std::vector<int>& cpus);
+
+// Settings for threads started from now on
+void setThreadTuning(ThreadTuning tuning);
+
+// Name the calling thread after role and apply the current settings. Called first
+// thing by every background thread; failures are reported to stderr and ignored.
+void tuneCurrentThread(const std::string& role);
+
+} // namespace Logging
@@ -0,0 +1,54 @@
+#include "timestampcache.h"
+#include <chrono>
+
+namespace Logging {
+
+bool timestampFormatFromString(const std::string& name, TimestampFormat& format) {
+    if (name == "local") {
+        format = TimestampFormat::Local;
+    } else if (name == "utc") {
+        format = TimestampFormat::Utc;
+    } else if (name == "iso8601") {
+        format = TimestampFormat::Iso8601;
+    } else if (name == "epoch_ns") {
+        format = TimestampFormat::EpochNanos;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+int64_t TimestampCache::epochNanos(spdlog::log_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+spdlog::string_view_t TimestampCache::render(spdlog::log_clock::time_point tp) {
+    auto dur = tp.time_since_epoch();
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(dur);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(dur - secs).count();
+    auto t = static_cast<std::time_t>(secs.count());
+
+    if (t != cachedSecond_) {
+        // New second: render the prefix once, the reentrant calls avoid the static tm buffer
+        std::tm bt{};
+        if (format_ == TimestampFormat::Local) {
+            localtime_r(&t, &bt);
+        } else {
+            gmtime_r(&t, &bt);
+        }
+        const char* pattern = format_ == TimestampFormat::Iso8601 ? "%Y-%m-%dT%H:%M:%S." : "%Y-%m-%d %H:%M:%S.";
+        millisOffset_ = std::strftime(buf_, sizeof(buf_), pattern, &bt);
+        length_ = millisOffset_ + 3;
+        if (format_ == TimestampFormat::Iso8601) {
+            buf_[length_++] = 'Z';
+        }
+        cachedSecond_ = t;
+    }
+
+    buf_[millisOffset_] = static_cast<char>('0' + ms / 100);
+    buf_[millisOffset_ + 1] = static_cast<char>('0' + ms / 10 % 10);
+    buf_[millisOffset_ + 2] = static_cast<char>('0' + ms % 10);
+    return spdlog::string_view_t(buf_, length_);
+}
+
+} // namespace Logging
@@ -0,0 +1,41 @@
+#pragma once
+#include <spdlog/common.h>
+#include <ctime>
+#include <string>
+
+namespace Logging {
+
+// How record times are rendered in structured output
+enum class TimestampFormat {
+    Local,      // "2024-05-01 13:45:10.123" in the local time zone
+    Utc,        // "2024-05-01 11:45:10.123" in UTC
+    Iso8601,    // "2024-05-01T11:45:10.123Z"
+    EpochNanos  // Nanoseconds since the Unix epoch, emitted as a JSON number
+};
+
+// Parse "local", "utc", "iso8601" or "epoch_ns"; returns false for anything else
+bool timestampFormatFromString(const std::string& name, TimestampFormat& format);
+
+// Renders timestamps, calling the time-zone conversion at most once per second.
+// The date-time prefix of the current second is kept and only the millisecond
+// digits are patched for further records. Not thread-safe, owned by one sink.
+class TimestampCache {
+public:
+    explicit TimestampCache(TimestampFormat format) : format_(format) {}
+
+    TimestampFormat format() const { return format_; }
+
+    // Text form of tp; the view stays valid until the next call
+    spdlog::string_view_t render(spdlog::log_clock::time_point tp);
+
+    static int64_t epochNanos(spdlog::log_clock::time_point tp);
+
+private:
+    TimestampFormat format_;
+    std::time_t cachedSecond_ = -1;
+    char buf_[40] = {};
+    size_t millisOffset_ = 0; // Position of the first millisecond digit in buf_
+    size_t length_ = 0;
+};
+
+} // namespace Logging
@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+
+namespace Bench {
+
+// Heap allocations of the whole process so far, counted by the global operator
+// new that allocationcounter.cpp replaces; only tools linking it may call this
+uint64_t allocations();
+
+} // namespace Bench
@@ -0,0 +1,52 @@
+#include "benchharness.h"
+#include <cstdlib>
+#include <vector>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace Bench {
+
+bool runInChild(const std::function<void(void* result)>& produce, void* result, std::size_t size) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    pid_t child = fork();
+    if (child == 0) {
+        close(fds[0]);
+        std::vector<char> measured(size);
+        produce(measured.data());
+        ssize_t written = write(fds[1], measured.data(), size);
+        _exit(written == static_cast<ssize_t>(size) ? 0 : 1);
+    }
+    close(fds[1]);
+    bool ok = child > 0 && read(fds[0], result, size) == static_cast<ssize_t>(size);
+    close(fds[0]);
+    if (child > 0) {
+        waitpid(child, nullptr, 0);
+    }
+    return ok;
+}
+
+void logToFile(const char* path, const char* level) {
+    setenv("LOG_MODE", "file", 1);
+    setenv("LOG_FILE_PATH", path, 1);
+    setenv("LOG_FILE_SIZE_MB", "4096", 0); // No rotation during a run
+    setenv("LOG_LEVEL", level, 0);
+}
+
+std::FILE* redirectConsole() {
+    std::FILE* out = fdopen(dup(STDOUT_FILENO), "w");
+    int devNull = open("/dev/null", O_WRONLY);
+    if (!out || devNull < 0) {
+        std::fprintf(stderr, "Cannot redirect the console sink\n");
+        return nullptr;
+    }
+    std::fflush(stdout);
+    dup2(devNull, STDOUT_FILENO);
+    close(devNull);
+    return out;
+}
+
+} // namespace Bench
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+// What the facade benchmarks share: each run in a fresh process, as the facade
+// does not start over after shutdown(), and a file-logging environment whose
+// console sink cannot mix with the results.
+namespace Bench {
+
+// Run produce() in a forked child, which writes size bytes of result back; false
+// if the child failed
+bool runInChild(const std::function<void(void* result)>& produce, void* result, std::size_t size);
+
+// The value run() returns in a child process; false if the child failed
+template <typename T>
+bool inChild(const std::function<T()>& run, T& result) {
+    static_assert(std::is_trivially_copyable<T>::value, "results travel through a pipe");
+    return runInChild([&run](void* out) {
+        T value = run();
+        std::memcpy(out, &value, sizeof(T));
+    }, &result, sizeof(T));
+}
+
+// Log at level to path through the file sink, never rotating during a run. Set
+// before the runs; LOG_LEVEL already in the environment wins.
+void logToFile(const char* path, const char* level);
+
+// The original stdout, for results, with stdout itself, and so the console sink,
+// going to /dev/null; null, after a message on stderr, if that failed
+std::FILE* redirectConsole();
+
+} // namespace Bench
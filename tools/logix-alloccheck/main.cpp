@@ -0,0 +1,162 @@
+#include "loggerfacade.h"
+#include "allocationcounter.h"
+#include "benchharness.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Checks that logging allocates nothing in steady state: once warm-up passes have
+// grown the rings and recycled buffers, every queue engine logs ordinary records
+// from several threads, and the heap allocations of the whole process, producers
+// and workers, are counted through operator new until the records are written.
+// Exits with 1 if any engine allocated. Each engine runs in a fresh process, as
+// the facade does not start over after shutdown(). The console sink writes to
+// /dev/null.
+// Usage: logix-alloccheck [records per thread] [log file]
+
+using namespace Logging;
+
+namespace {
+
+constexpr int kThreads = 4;
+
+// Passes allowed to reach steady state before the measured one
+constexpr int kWarmUpPasses = 10;
+
+// Threads that log a pass of ordinary records each time they are told to. They
+// live across passes, so thread creation and the spsc engine's per-thread rings
+// fall outside the measured passes. The records are short enough for a queue slot
+// and for the formatting buffers; larger payloads are counted by payloadPoolStats().
+class Producers {
+public:
+    Producers(std::shared_ptr<spdlog::logger> logger, long records)
+        : logger_(std::move(logger)), records_(records) {
+        for (int t = 0; t < kThreads; ++t) {
+            threads_.emplace_back([this, t]() { serve(t); });
+        }
+    }
+
+    ~Producers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        start_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    // Every thread logs its records once; returns when all are done
+    void runPass() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++pass_;
+        finished_ = 0;
+        start_.notify_all();
+        done_.wait(lock, [this]() { return finished_ == kThreads; });
+    }
+
+private:
+    void serve(int t) {
+        long seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_.wait(lock, [this, seen]() { return stopping_ || pass_ != seen; });
+                if (stopping_) {
+                    return;
+                }
+                seen = pass_;
+            }
+            for (long i = 0; i < records_; ++i) {
+                if (i % 10 == 0) {
+                    logger_->warn("thread {} request {} retried after {} ms", t, i, i % 100);
+                } else {
+                    logger_->info("thread {} request {} served in {} us", t, i, i % 1000);
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (++finished_ == kThreads) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    std::shared_ptr<spdlog::logger> logger_;
+    const long records_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    long pass_ = 0;
+    int finished_ = 0;
+    bool stopping_ = false;
+};
+
+// Allocations of one pass until the workers are idle again
+long long countPass(Producers& producers) {
+    uint64_t before = Bench::allocations();
+    producers.runPass();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    return static_cast<long long>(Bench::allocations() - before);
+}
+
+// Allocations while the threads logged and the records were written
+long long measure(const char* engine, long records) {
+    setenv("LOG_QUEUE_ENGINE", engine, 1);
+    auto& facade = LoggerFacade::getInstance();
+    facade.initialize();
+    long long counted = -1;
+    {
+        Producers producers(facade.getLogger(), records);
+        // Warm-up passes create the rings, the rendered records and pooled buffers,
+        // and grow them to the backlog the load builds up, until one allocates nothing
+        for (int pass = 0; pass < kWarmUpPasses && counted != 0; ++pass) {
+            counted = countPass(producers);
+        }
+        if (counted == 0) {
+            counted = countPass(producers);
+        }
+    }
+    facade.shutdown();
+    return counted;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long records = argc > 1 ? std::atol(argv[1]) : 10000 / kThreads;
+    const char* path = argc > 2 ? argv[2] : "/tmp/logix-alloccheck.log";
+    if (records <= 0) {
+        std::fprintf(stderr, "Usage: %s [records per thread] [log file]\n", argv[0]);
+        return 2;
+    }
+
+    Bench::logToFile(path, "info"); // Rotation would rename and allocate
+    setenv("LOG_OVERFLOW_BLOCK_LEVEL", "trace", 0); // No drop summaries
+    std::FILE* out = Bench::redirectConsole();
+    if (!out) {
+        return 1;
+    }
+
+    bool failed = false;
+    for (const char* engine : {"spdlog", "mpsc", "spsc"}) {
+        std::remove(path);
+        long long counted = -1;
+        if (!Bench::inChild<long long>([&]() { return measure(engine, records); }, counted) || counted < 0) {
+            std::fprintf(out, "%-8s run failed\n", engine);
+            failed = true;
+            continue;
+        }
+        std::fprintf(out, "%-8s %ld records: %lld allocations %s\n", engine, records * kThreads, counted,
+                     counted == 0 ? "ok" : "FAILED");
+        failed = failed || counted != 0;
+    }
+    std::fflush(out);
+    std::remove(path);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,70 @@
+#include "logclock.h"
+#include <spdlog/details/os.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Measures the per-call cost of the clock sources LOG_CLOCK can select, next to
+// the clock spdlog's own front end reads, and the worker-side TSC conversion.
+// Usage: logix-clockbench [iterations]
+
+using namespace Logging;
+
+namespace {
+
+// Nanoseconds per call of read, averaged over iterations calls
+template <typename Read>
+double measure(Read read, long iterations) {
+    int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i) {
+        sum += read();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    // Keep the reads from being optimized away
+    volatile int64_t keep = sum;
+    (void)keep;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+void report(const char* name, double nanos) {
+    std::printf("%-36s %8.2f ns/call\n", name, nanos);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? std::atol(argv[1]) : 10000000;
+    if (iterations <= 0) {
+        std::fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return 2;
+    }
+
+    report("spdlog os::now (spdlog front end)", measure([] {
+        return spdlog::details::os::now().time_since_epoch().count();
+    }, iterations));
+
+    LogClock::select(ClockSource::Realtime);
+    report("realtime (CLOCK_REALTIME)", measure(LogClock::stamp, iterations));
+
+    LogClock::select(ClockSource::Coarse);
+    report("coarse (CLOCK_REALTIME_COARSE)", measure(LogClock::stamp, iterations));
+
+    if (!LogClock::tscReliable()) {
+        std::printf("tsc: not invariant or not trusted by the kernel, LOG_CLOCK=tsc falls back to coarse\n");
+        return 0;
+    }
+    LogClock::select(ClockSource::Tsc);
+    report("tsc (rdtsc)", measure(LogClock::stamp, iterations));
+    int64_t stamp = LogClock::stamp();
+    report("tsc conversion on the worker", measure([&stamp] {
+        return LogClock::toEpochNanos(stamp++);
+    }, iterations));
+
+    // How far a converted stamp is from CLOCK_REALTIME read right after it
+    int64_t ticks = LogClock::readTsc();
+    int64_t realtime = LogClock::realtimeNanos();
+    std::printf("%-36s %8lld ns\n", "tsc offset from realtime",
+                static_cast<long long>(LogClock::toEpochNanos(ticks) - realtime));
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "benchharness.h"
+#include "crashring.h"
+#include "loggerfacade.h"
+#include <spdlog/details/log_msg.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Measures what the crash ring costs: CrashRingSink::log on its own, from 1 to 8
+// threads sharing the ring's head, then the time a thread spends per log call
+// through the facade, on each queue engine, with LOG_CRASH_RING_PATH unset and
+// set. Nothing is dropped. Each facade run is a fresh process, as the facade does
+// not start over after shutdown(). The console sink writes to /dev/null.
+// Usage: logix-crashbench [records per thread] [ring file] [log file]
+
+using namespace Logging;
+
+namespace {
+
+constexpr size_t kRingBytes = 4 * 1024 * 1024;
+
+// Nanoseconds per call of log(t, i) on each of threads threads, averaged over them
+template <typename Log>
+double measure(int threads, long records, Log&& log) {
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<int64_t> callNanos{0};
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; ++t) {
+        producers.emplace_back([&, t]() {
+            ready.fetch_add(1);
+            while (!go.load()) {
+            }
+            auto start = std::chrono::steady_clock::now();
+            for (long i = 0; i < records; ++i) {
+                log(t, i);
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            callNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        });
+    }
+    while (ready.load() < threads) {
+    }
+    go.store(true);
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    return static_cast<double>(callNanos.load()) / static_cast<double>(threads * records);
+}
+
+// The ring write alone, on a message as a logger hands it to its sinks
+double measureRing(const char* ringPath, int threads, long records) {
+    std::remove(ringPath);
+    CrashRingSink ring(ringPath, kRingBytes);
+    std::string payload = "request 123456 served in 789 us for client 10.0.0.17";
+    spdlog::details::log_msg msg(spdlog::source_loc{__FILE__, __LINE__, "measureRing"}, "logix",
+                                 spdlog::level::info, payload);
+    return measure(threads, records, [&ring, &msg](int, long) { ring.log(msg); });
+}
+
+// One log call through the facade, ring included when LOG_CRASH_RING_PATH is set
+double measureFacade(const char* engine, const char* ringPath, int threads, long records) {
+    setenv("LOG_QUEUE_ENGINE", engine, 1);
+    if (ringPath) {
+        std::remove(ringPath);
+        setenv("LOG_CRASH_RING_PATH", ringPath, 1);
+    } else {
+        unsetenv("LOG_CRASH_RING_PATH");
+    }
+    auto& facade = LoggerFacade::getInstance();
+    facade.initialize();
+    auto logger = facade.getLogger();
+    double nanos = measure(threads, records, [&logger](int t, long i) {
+        logger->info("thread {} request {} served in {} us", t, i, i % 1000);
+    });
+    logger.reset();
+    facade.shutdown();
+    return nanos;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long records = argc > 1 ? std::atol(argv[1]) : 200000;
+    const char* ringPath = argc > 2 ? argv[2] : "/dev/shm/logix-crashbench.ring";
+    const char* path = argc > 3 ? argv[3] : "/tmp/logix-crashbench.log";
+    if (records <= 0) {
+        std::fprintf(stderr, "Usage: %s [records per thread] [ring file] [log file]\n", argv[0]);
+        return 2;
+    }
+    std::string previousRing = std::string(ringPath) + ".prev";
+
+    Bench::logToFile(path, "info");
+    setenv("LOG_CRASH_RING_MB", "4", 0);
+    setenv("LOG_OVERFLOW_BLOCK_LEVEL", "trace", 0); // Every record is written, none dropped
+    std::FILE* out = Bench::redirectConsole();
+    if (!out) {
+        return 1;
+    }
+
+    std::fprintf(out, "%ld records per thread, ring %s, file %s\n", records, ringPath, path);
+    std::fprintf(out, "%-8s %7s %12s\n", "ring", "threads", "ns/record");
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        std::fprintf(out, "%-8s %7d %12.1f\n", "alone", threads, measureRing(ringPath, threads, records));
+        std::fflush(out);
+    }
+
+    std::fprintf(out, "%-8s %7s %12s %12s %12s\n", "engine", "threads", "ring off", "ring on", "ns/call");
+    for (const char* engine : {"spdlog", "mpsc", "spsc"}) {
+        for (int threads : {1, 4}) {
+            double off = 0;
+            double on = 0;
+            std::remove(path);
+            auto ringOff = [&]() { return measureFacade(engine, nullptr, threads, records); };
+            auto ringOn = [&]() { return measureFacade(engine, ringPath, threads, records); };
+            bool ok = Bench::inChild<double>(ringOff, off);
+            std::remove(path);
+            ok = ok && Bench::inChild<double>(ringOn, on);
+            if (!ok) {
+                std::fprintf(stderr, "%s with %d threads: run failed\n", engine, threads);
+                return 1;
+            }
+            std::fprintf(out, "%-8s %7d %12.1f %12.1f %+12.1f\n", engine, threads, off, on, on - off);
+            std::fflush(out);
+        }
+    }
+    std::remove(path);
+    std::remove(ringPath);
+    std::remove(previousRing.c_str());
+    return 0;
+}
@@ -0,0 +1,17 @@
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= app_bundle qt
+
+DEFINES += SPDLOG_HEADER_ONLY
+
+INCLUDEPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../../spdlog/include
+
+SOURCES += \
+    main.cpp \
+    ../../binaryformat.cpp \
+    ../../jsonwriter.cpp
+
+HEADERS += \
+    ../../binaryformat.h \
+    ../../jsonwriter.h
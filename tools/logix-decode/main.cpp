@@ -0,0 +1,229 @@
+#include "binaryformat.h"
+#include "jsonwriter.h"
+#include <spdlog/fmt/fmt.h>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Decodes binary log files written in LOG_MODE=binary into text or JSON lines.
+// Usage: logix-decode [--json] <file>...
+
+using namespace Logging;
+
+namespace {
+
+struct Site {
+    bool known = false;
+    spdlog::level::level_enum level = spdlog::level::info;
+    uint32_t line = 0;
+    std::string format;
+    std::string file;
+};
+
+class Reader {
+public:
+    explicit Reader(std::FILE* file) : file_(file) {}
+
+    template <typename V>
+    bool read(V& value) {
+        return std::fread(&value, sizeof(V), 1, file_) == 1;
+    }
+
+    bool read(std::string& value, size_t size) {
+        value.resize(size);
+        return size == 0 || std::fread(&value[0], 1, size, file_) == size;
+    }
+
+    bool readString(std::string& value) {
+        uint32_t size;
+        return read(size) && read(value, size);
+    }
+
+private:
+    std::FILE* file_;
+};
+
+class Decoder {
+public:
+    explicit Decoder(bool json) : json_(json) {}
+
+    // Returns false if the file is not a binary log or ends in the middle of an entry
+    bool decode(std::FILE* file, const char* path) {
+        Reader reader(file);
+        uint8_t type;
+        while (reader.read(type)) {
+            bool ok = false;
+            if (type == static_cast<uint8_t>(BinaryFormat::kMagic[0])) {
+                ok = readHeader(reader, path);
+            } else if (!inSession_) {
+                std::fprintf(stderr, "%s: not a Logix binary log\n", path);
+                return false;
+            } else if (type == static_cast<uint8_t>(BinaryFormat::EntryType::Site)) {
+                ok = readSite(reader);
+            } else if (type == static_cast<uint8_t>(BinaryFormat::EntryType::Record)) {
+                ok = readRecord(reader);
+            } else if (type == static_cast<uint8_t>(BinaryFormat::EntryType::Dropped)) {
+                ok = readDropped(reader);
+            } else {
+                std::fprintf(stderr, "%s: unknown entry type %u\n", path, type);
+                return false;
+            }
+            if (!ok) {
+                // A crash can leave the last entry incomplete; everything before it is valid
+                std::fprintf(stderr, "%s: truncated entry at end of file\n", path);
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    bool readHeader(Reader& reader, const char* path) {
+        std::string magic;
+        uint32_t version;
+        uint32_t mark;
+        if (!reader.read(magic, sizeof(BinaryFormat::kMagic) - 1) || !reader.read(version) || !reader.read(mark)) {
+            return false;
+        }
+        if (std::memcmp(magic.data(), BinaryFormat::kMagic + 1, magic.size()) != 0) {
+            std::fprintf(stderr, "%s: not a Logix binary log\n", path);
+            return false;
+        }
+        if (version != BinaryFormat::kVersion || mark != BinaryFormat::kByteOrderMark) {
+            std::fprintf(stderr, "%s: unsupported version or byte order\n", path);
+            return false;
+        }
+        // Site ids are only valid within their session
+        sites_.clear();
+        inSession_ = true;
+        return true;
+    }
+
+    bool readSite(Reader& reader) {
+        uint32_t id;
+        uint8_t level;
+        Site site;
+        if (!reader.read(id) || !reader.read(level) || !reader.read(site.line) ||
+            !reader.readString(site.format) || !reader.readString(site.file)) {
+            return false;
+        }
+        site.known = true;
+        site.level = static_cast<spdlog::level::level_enum>(level);
+        if (id >= sites_.size()) {
+            sites_.resize(id + 1);
+        }
+        sites_[id] = std::move(site);
+        return true;
+    }
+
+    bool readRecord(Reader& reader) {
+        uint32_t siteId;
+        uint32_t threadId;
+        int64_t timeNs;
+        uint16_t argsSize;
+        uint8_t truncated;
+        if (!reader.read(siteId) || !reader.read(threadId) || !reader.read(timeNs) || !reader.read(argsSize) ||
+            !reader.read(truncated) || !reader.read(args_, argsSize)) {
+            return false;
+        }
+
+        message_.clear();
+        static const Site unknown;
+        const Site& site = siteId < sites_.size() ? sites_[siteId] : unknown;
+        if (site.known) {
+            BinaryFormat::formatMessage(site.format, args_.data(), args_.size(), message_);
+        } else {
+            fmt::format_to(std::back_inserter(message_), "[unknown site {}]", siteId);
+        }
+        if (truncated) {
+            message_.append(spdlog::string_view_t(" [truncated]"));
+        }
+
+        std::string time = formatTime(timeNs);
+        spdlog::string_view_t level = spdlog::level::to_string_view(site.level);
+        spdlog::string_view_t message(message_.data(), message_.size());
+        if (json_) {
+            line_.clear();
+            JsonWriter writer(line_);
+            writer.beginObject();
+            writer.field("time", time);
+            writer.field("level", level);
+            writer.numberField("thread", static_cast<uint64_t>(threadId));
+            writer.field("file", site.file);
+            writer.numberField("line", static_cast<uint64_t>(site.line));
+            writer.field("message", message);
+            writer.endObject();
+            std::fwrite(line_.data(), 1, line_.size(), stdout);
+            std::fputc('\n', stdout);
+        } else {
+            fmt::print("{} [{}] [{}] {}\n", time, level, threadId, message);
+        }
+        return true;
+    }
+
+    bool readDropped(Reader& reader) {
+        uint64_t count;
+        if (!reader.read(count)) {
+            return false;
+        }
+        if (json_) {
+            fmt::print("{{\"dropped\":{}}}\n", count);
+        } else {
+            fmt::print("*** {} records dropped ***\n", count);
+        }
+        return true;
+    }
+
+    static std::string formatTime(int64_t timeNs) {
+        std::time_t seconds = static_cast<std::time_t>(timeNs / 1000000000);
+        std::tm tm{};
+        localtime_r(&seconds, &tm);
+        char prefix[32];
+        std::strftime(prefix, sizeof(prefix), "%Y-%m-%d %H:%M:%S", &tm);
+        return fmt::format("{}.{:06}", prefix, (timeNs % 1000000000) / 1000);
+    }
+
+    bool json_;
+    bool inSession_ = false;
+    std::vector<Site> sites_;
+    std::string args_;
+    spdlog::memory_buf_t message_;
+    spdlog::memory_buf_t line_;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool json = false;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty()) {
+        std::fprintf(stderr, "Usage: %s [--json] <file>...\n", argv[0]);
+        return 2;
+    }
+
+    int status = 0;
+    for (const char* path : paths) {
+        std::FILE* file = std::fopen(path, "rb");
+        if (!file) {
+            std::fprintf(stderr, "%s: cannot open file\n", path);
+            status = 1;
+            continue;
+        }
+        Decoder decoder(json);
+        if (!decoder.decode(file, path)) {
+            status = 1;
+        }
+        std::fclose(file);
+    }
+    return status;
+}
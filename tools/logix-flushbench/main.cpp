@@ -0,0 +1,106 @@
+#include "benchharness.h"
+#include "loggerfacade.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Measures file logging throughput under each flush policy, from flushing every
+// record (what flush_on(trace) used to do) to group commit at queue drains, with
+// and without fdatasync. The clock runs until shutdown() has written and flushed
+// the last record. Each policy runs in a fresh process, as the facade does not
+// start over after shutdown(). The console sink, which is always on, writes to /dev/null.
+// Usage: logix-flushbench [threads] [records per thread] [log file]
+
+using namespace Logging;
+
+namespace {
+
+struct Policy {
+    const char* name;
+    std::vector<std::pair<const char*, const char*>> env;
+};
+
+const char* const kPolicyVariables[] = {"LOG_FLUSH_LEVEL", "LOG_FLUSH_ON_DRAIN", "LOG_FLUSH_INTERVAL_MS",
+                                        "LOG_FLUSH_BYTES", "LOG_FLUSH_SYNC"};
+
+// Records per second from the first record until shutdown() returns
+double measure(const Policy& policy, int threads, long records) {
+    for (const char* name : kPolicyVariables) {
+        unsetenv(name);
+    }
+    for (const auto& variable : policy.env) {
+        setenv(variable.first, variable.second, 1);
+    }
+    auto& facade = LoggerFacade::getInstance();
+    facade.initialize();
+    auto logger = facade.getLogger();
+
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&logger, &go, t, records]() {
+            while (!go.load()) {
+            }
+            for (long i = 0; i < records; ++i) {
+                logger->info("thread {} request {} served in {} us", t, i, i % 1000);
+            }
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    logger.reset();
+    facade.shutdown();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(threads) * static_cast<double>(records)
+           / std::chrono::duration<double>(elapsed).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int threads = argc > 1 ? std::atoi(argv[1]) : 4;
+    long records = argc > 2 ? std::atol(argv[2]) : 250000;
+    const char* path = argc > 3 ? argv[3] : "/tmp/logix-flushbench.log";
+    if (threads <= 0 || records <= 0) {
+        std::fprintf(stderr, "Usage: %s [threads] [records per thread] [log file]\n", argv[0]);
+        return 2;
+    }
+
+    Bench::logToFile(path, "info");
+    setenv("LOG_OVERFLOW_BLOCK_LEVEL", "trace", 0); // Every record is written, none dropped
+    std::FILE* out = Bench::redirectConsole();
+    if (!out) {
+        return 1;
+    }
+
+    const Policy policies[] = {
+        {"every record", {{"LOG_FLUSH_LEVEL", "trace"}, {"LOG_FLUSH_ON_DRAIN", "off"}}},
+        {"level error only", {{"LOG_FLUSH_ON_DRAIN", "off"}}},
+        {"every 64 KiB", {{"LOG_FLUSH_ON_DRAIN", "off"}, {"LOG_FLUSH_BYTES", "65536"}}},
+        {"every 100 ms", {{"LOG_FLUSH_ON_DRAIN", "off"}, {"LOG_FLUSH_INTERVAL_MS", "100"}}},
+        {"on drain (default)", {}},
+        {"on drain + fdatasync", {{"LOG_FLUSH_SYNC", "on"}}},
+        {"every record + fdatasync", {{"LOG_FLUSH_LEVEL", "trace"}, {"LOG_FLUSH_ON_DRAIN", "off"},
+                                      {"LOG_FLUSH_SYNC", "on"}}},
+    };
+    std::fprintf(out, "%d threads, %ld records each, file %s\n", threads, records, path);
+    for (const Policy& policy : policies) {
+        std::remove(path);
+        double perSecond = 0;
+        if (!Bench::inChild<double>([&]() { return measure(policy, threads, records); }, perSecond)) {
+            std::fprintf(stderr, "%s: run failed\n", policy.name);
+            return 1;
+        }
+        std::fprintf(out, "%-26s %12.0f records/s %8.1f ns/record\n", policy.name, perSecond, 1e9 / perSecond);
+        std::fflush(out);
+    }
+    std::remove(path);
+    return 0;
+}
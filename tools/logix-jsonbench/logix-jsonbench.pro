@@ -0,0 +1,21 @@
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= app_bundle qt
+
+DEFINES += SPDLOG_HEADER_ONLY
+
+INCLUDEPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../common
+INCLUDEPATH += $$PWD/../../spdlog/include
+INCLUDEPATH += $$PWD/../../nlohmann/include
+
+SOURCES += \
+    main.cpp \
+    ../common/allocationcounter.cpp \
+    ../../jsonwriter.cpp \
+    ../../timestampcache.cpp
+
+HEADERS += \
+    ../common/allocationcounter.h \
+    ../../jsonwriter.h \
+    ../../timestampcache.h
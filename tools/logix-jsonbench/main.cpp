@@ -0,0 +1,162 @@
+#include "allocationcounter.h"
+#include "jsonwriter.h"
+#include "timestampcache.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Compares the UDP sink's JSON encoding, the streaming JsonWriter with the
+// TimestampCache, with the code it replaced: the record copied to a string, its
+// time rendered through localtime and an ostringstream, and a nlohmann::json
+// object dumped. Nanoseconds and heap allocations per record, counted through
+// operator new. Both must produce the same bytes.
+// Exits with 1 if they differ or if the writer allocated once warmed up.
+// Usage: logix-jsonbench [records]
+
+using namespace Logging;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// A formatted record as the sink receives it
+struct Record {
+    spdlog::log_clock::time_point time;
+    spdlog::level::level_enum level;
+    spdlog::memory_buf_t text;
+};
+
+struct Result {
+    double nsPerRecord = 0;
+    double allocationsPerRecord = 0;
+};
+
+// Records a quarter millisecond apart, every eighth with characters to escape
+std::vector<Record> makeRecords(size_t count) {
+    static const spdlog::level::level_enum levels[] = {spdlog::level::debug, spdlog::level::info,
+                                                       spdlog::level::warn, spdlog::level::err};
+    std::vector<Record> records;
+    records.reserve(count);
+    auto time = spdlog::log_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        Record record;
+        record.time = time + std::chrono::microseconds(250 * i);
+        record.level = levels[i % 4];
+        if (i % 8 == 0) {
+            fmt::format_to(std::back_inserter(record.text), "request {} failed: \"path\\to\\{}\"\tcode {}\x01", i,
+                           i % 97, i % 500);
+        } else {
+            fmt::format_to(std::back_inserter(record.text), "request {} served in {} us from cache shard {}", i,
+                           i % 1000, i % 16);
+        }
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+// What UdpSink::send does for a JSON record
+void encodeWithWriter(const Record& record, TimestampCache& timestamps, spdlog::memory_buf_t& out) {
+    out.clear();
+    JsonWriter writer(out);
+    writer.beginObject();
+    writer.field("level", spdlog::level::to_string_view(record.level));
+    writer.field("logger", "app");
+    writer.field("message", spdlog::string_view_t(record.text.data(), record.text.size()));
+    writer.field("time", timestamps.render(record.time));
+    writer.endObject();
+}
+
+// What UdpSink::log did for a JSON record before the writer, unchanged
+std::string encodeWithNlohmann(const Record& record) {
+    const spdlog::memory_buf_t& formatted = record.text;
+    std::string plain_msg = fmt::to_string(formatted);
+
+    // Calculate time components without fmt
+    auto dur = record.time.time_since_epoch();
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(dur);
+    auto tp_whole_sec = std::chrono::system_clock::time_point(secs);
+    auto t = std::chrono::system_clock::to_time_t(tp_whole_sec);
+    std::tm bt = *std::localtime(&t);  // Use localtime to match fmt's default behavior for chrono
+    std::ostringstream ss;
+    ss << std::put_time(&bt, "%Y-%m-%d %H:%M:%S");
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(dur - secs).count();
+    ss << '.' << std::setfill('0') << std::setw(3) << ms;
+    std::string time_str = ss.str();
+
+    // Convert to JSON
+    nlohmann::json json_msg = {
+        {"time", time_str},
+        {"level", spdlog::level::to_string_view(record.level).data()},
+        {"logger", "app"},
+        {"message", plain_msg}
+    };
+    return json_msg.dump();
+}
+
+// Runs encode over all records after one warm-up pass
+template <typename Encode>
+Result measure(const std::vector<Record>& records, Encode&& encode) {
+    for (const auto& record : records) {
+        encode(record);
+    }
+    uint64_t before = Bench::allocations();
+    auto start = Clock::now();
+    for (const auto& record : records) {
+        encode(record);
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    Result result;
+    result.nsPerRecord = ns / static_cast<double>(records.size());
+    result.allocationsPerRecord =
+        static_cast<double>(Bench::allocations() - before) / static_cast<double>(records.size());
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long count = argc > 1 ? std::atol(argv[1]) : 200000;
+    if (count <= 0) {
+        std::fprintf(stderr, "Usage: %s [records]\n", argv[0]);
+        return 2;
+    }
+    auto records = makeRecords(static_cast<size_t>(count));
+
+    // Same bytes from both encoders
+    TimestampCache writerTimes(TimestampFormat::Local);
+    spdlog::memory_buf_t buffer;
+    for (const auto& record : records) {
+        encodeWithWriter(record, writerTimes, buffer);
+        std::string expected = encodeWithNlohmann(record);
+        if (spdlog::string_view_t(buffer.data(), buffer.size()) != spdlog::string_view_t(expected)) {
+            std::fprintf(stderr, "Encodings differ:\n  JsonWriter: %.*s\n  original:   %s\n",
+                         static_cast<int>(buffer.size()), buffer.data(), expected.c_str());
+            return 1;
+        }
+    }
+
+    Result writer = measure(records, [&writerTimes, &buffer](const Record& record) {
+        encodeWithWriter(record, writerTimes, buffer);
+    });
+    size_t bytes = 0; // Also keeps the dumped strings from being optimized away
+    Result nlohmann = measure(records, [&bytes](const Record& record) {
+        bytes += encodeWithNlohmann(record).size();
+    });
+
+    std::printf("%ld records, %zu bytes of JSON each on average\n", count, bytes / 2 / records.size());
+    std::printf("%-12s %10s %14s\n", "encoder", "ns/record", "allocs/record");
+    std::printf("%-12s %10.1f %14.2f\n", "JsonWriter", writer.nsPerRecord, writer.allocationsPerRecord);
+    std::printf("%-12s %10.1f %14.2f\n", "original", nlohmann.nsPerRecord, nlohmann.allocationsPerRecord);
+    if (writer.allocationsPerRecord > 0) {
+        std::fprintf(stderr, "JsonWriter allocated while encoding\n");
+        return 1;
+    }
+    return 0;
+}
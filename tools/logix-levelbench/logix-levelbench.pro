@@ -0,0 +1,71 @@
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= app_bundle qt
+
+DEFINES += SPDLOG_HEADER_ONLY
+
+INCLUDEPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../../spdlog/include
+INCLUDEPATH += $$PWD/../../nlohmann/include
+
+# zlib compresses rotated log files
+LIBS += -lz
+
+SOURCES += \
+    main.cpp \
+    ../../asyncpipeline.cpp \
+    ../../asyncsink.cpp \
+    ../../binaryformat.cpp \
+    ../../binarylog.cpp \
+    ../../consolesink.cpp \
+    ../../crashring.cpp \
+    ../../dedupsink.cpp \
+    ../../fanoutsink.cpp \
+    ../../flightrecorder.cpp \
+    ../../flushpolicy.cpp \
+    ../../jsonwriter.cpp \
+    ../../levelgate.cpp \
+    ../../logclock.cpp \
+    ../../loggerfacade.cpp \
+    ../../overflowguard.cpp \
+    ../../payloadpool.cpp \
+    ../../prioritylane.cpp \
+    ../../queuebudget.cpp \
+    ../../rotatingfilesink.cpp \
+    ../../spscstaging.cpp \
+    ../../threadtuning.cpp \
+    ../../timestampcache.cpp \
+    ../../udpsink.cpp \
+    ../../udptransport.cpp
+
+HEADERS += \
+    ../../activelevel.h \
+    ../../asyncpipeline.h \
+    ../../asyncsink.h \
+    ../../binaryformat.h \
+    ../../binarylog.h \
+    ../../consolesink.h \
+    ../../crashring.h \
+    ../../crashringformat.h \
+    ../../dedupsink.h \
+    ../../eventcount.h \
+    ../../fanoutsink.h \
+    ../../flightrecorder.h \
+    ../../flushpolicy.h \
+    ../../formattedsink.h \
+    ../../jsonwriter.h \
+    ../../levelgate.h \
+    ../../logclock.h \
+    ../../loggerfacade.h \
+    ../../mpscring.h \
+    ../../overflowguard.h \
+    ../../payloadpool.h \
+    ../../prioritylane.h \
+    ../../queuebudget.h \
+    ../../rotatingfilesink.h \
+    ../../spscring.h \
+    ../../spscstaging.h \
+    ../../threadtuning.h \
+    ../../timestampcache.h \
+    ../../udpsink.h \
+    ../../udptransport.h
@@ -0,0 +1,102 @@
+#include "loggerfacade.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Measures the cost of a disabled debug statement on each way of logging through
+// the facade, with every thread logging at once: fetching the logger per call
+// as the README's first example does, keeping the logger, and the LOGIX_* macros.
+// Then the cost of a statement the flight recorder captures; unless
+// LOG_FLIGHT_RECORDER says otherwise, it captures debug and up, and the bench
+// fails if it does not capture debug. Logs to /dev/null unless LOG_MODE is set.
+// Usage: logix-levelbench [threads] [iterations per thread]
+
+using namespace Logging;
+
+namespace {
+
+// Nanoseconds per statement, averaged over all threads
+template <typename Statement>
+double measure(Statement statement, int threads, long iterations) {
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<int64_t> totalNanos{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            ready.fetch_add(1);
+            while (!go.load()) {
+            }
+            auto start = std::chrono::steady_clock::now();
+            for (long i = 0; i < iterations; ++i) {
+                statement(i);
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            totalNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        });
+    }
+    while (ready.load() < threads) {
+    }
+    go.store(true);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return static_cast<double>(totalNanos.load()) / static_cast<double>(threads) / static_cast<double>(iterations);
+}
+
+void report(const char* name, double nanos) {
+    std::printf("%-36s %8.2f ns/statement\n", name, nanos);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int threads = argc > 1 ? std::atoi(argv[1]) : 4;
+    long iterations = argc > 2 ? std::atol(argv[2]) : 10000000;
+    if (threads <= 0 || iterations <= 0) {
+        std::fprintf(stderr, "Usage: %s [threads] [iterations per thread]\n", argv[0]);
+        return 2;
+    }
+
+    // Mode none would leave the recorder off; the file takes nothing but the banner
+    setenv("LOG_MODE", "file", 0);
+    setenv("LOG_FILE_PATH", "/dev/null", 0);
+    setenv("LOG_FLIGHT_RECORDER", "debug", 0);
+    auto& facade = LoggerFacade::getInstance();
+    facade.initialize();
+    facade.setLogLevel(spdlog::level::info);
+    if (!FlightRecorder::instance().captures(spdlog::level::debug)) {
+        std::fprintf(stderr, "Flight recorder does not capture debug records; check LOG_MODE and LOG_FLIGHT_RECORDER\n");
+        facade.shutdown();
+        return 1;
+    }
+
+    std::printf("Disabled statement, %d threads\n", threads);
+    report("getLogger()->debug per call", measure([&facade](long i) {
+        facade.getLogger()->debug("iteration {}", i);
+    }, threads, iterations));
+
+    auto logger = facade.getLogger();
+    report("logger->debug on a kept logger", measure([&logger](long i) {
+        logger->debug("iteration {}", i);
+    }, threads, iterations));
+
+    report("LOGIX_TRACE", measure([](long i) {
+        LOGIX_TRACE("iteration {}", i);
+    }, threads, iterations));
+
+    std::printf("Flight recorder capture, %d threads\n", threads);
+    report("LOGIX_DEBUG, integer argument", measure([](long i) {
+        LOGIX_DEBUG("iteration {}", i);
+    }, threads, iterations));
+
+    report("LOGIX_DEBUG, string argument", measure([](long i) {
+        LOGIX_DEBUG("iteration {} of {}", i, "levelbench");
+    }, threads, iterations));
+
+    facade.shutdown();
+    return 0;
+}
@@ -0,0 +1,229 @@
+#include "benchharness.h"
+#include "loggerfacade.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Measures the latency of critical records while other threads flood the queue
+// with debug records, on each queue engine: without the priority lane as the
+// baseline, with the lane alone and with LOG_PRIORITY_SYNC. Two times are
+// reported: until the file sink has flushed the record
+// (LoggerFacade::priorityLatency, lane runs only), and until the record shows up
+// in the log file, as seen by a thread tailing it, for every run. Each run is a
+// fresh process, as the facade does not start over after shutdown(). The console
+// sink writes to /dev/null.
+// Usage: logix-prioritybench [flooding threads] [critical records] [log file]
+
+using namespace Logging;
+
+namespace {
+
+constexpr char kMarker[] = "critical event ";
+
+struct Result {
+    PriorityLatency::Snapshot flushed;
+    uint64_t seen = 0; // Critical records found in the file
+    double seenMeanUs = 0;
+    double seenMaxUs = 0;
+};
+
+// Tails the log file and notes when each "critical event <i>" line arrives
+class FileArrivals {
+public:
+    FileArrivals(const char* path, int criticals)
+        : fd_(open(path, O_RDONLY)), logged_(new std::atomic<int64_t>[criticals]),
+          arrived_(new int64_t[criticals]), criticals_(criticals) {
+        for (int i = 0; i < criticals; ++i) {
+            logged_[i].store(0);
+            arrived_[i] = 0;
+        }
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    ~FileArrivals() {
+        stop_.store(true);
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void logged(int i) {
+        logged_[i].store(now(), std::memory_order_release);
+    }
+
+    // Call once the records are written; scans what is left, then stops
+    void finish(Result& result) {
+        stop_.store(true);
+        thread_.join();
+        int64_t total = 0;
+        int64_t max = 0;
+        for (int i = 0; i < criticals_; ++i) {
+            int64_t logged = logged_[i].load(std::memory_order_acquire);
+            if (arrived_[i] == 0 || logged == 0) {
+                continue;
+            }
+            int64_t latency = std::max<int64_t>(arrived_[i] - logged, 0);
+            total += latency;
+            max = std::max(max, latency);
+            ++result.seen;
+        }
+        if (result.seen > 0) {
+            result.seenMeanUs = static_cast<double>(total) / static_cast<double>(result.seen) / 1e3;
+            result.seenMaxUs = static_cast<double>(max) / 1e3;
+        }
+    }
+
+private:
+    void run() {
+        std::vector<char> buffer(1 << 20);
+        size_t kept = 0;
+        for (;;) {
+            bool last = stop_.load();
+            ssize_t got = fd_ < 0 ? 0 : read(fd_, buffer.data() + kept, buffer.size() - kept);
+            if (got <= 0) {
+                if (last) {
+                    return;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+                continue;
+            }
+            int64_t arrival = now();
+            size_t size = kept + static_cast<size_t>(got);
+            // Only complete lines; the rest waits for the next read
+            const char* end = static_cast<const char*>(memrchr(buffer.data(), '\n', size));
+            if (!end) {
+                kept = size == buffer.size() ? 0 : size;
+                continue;
+            }
+            scan(buffer.data(), end, arrival);
+            size_t used = static_cast<size_t>(end - buffer.data()) + 1;
+            kept = size - used;
+            std::memmove(buffer.data(), buffer.data() + used, kept);
+        }
+    }
+
+    void scan(const char* begin, const char* end, int64_t arrival) {
+        const size_t markerSize = sizeof(kMarker) - 1;
+        while (const char* found = static_cast<const char*>(
+                   memmem(begin, static_cast<size_t>(end - begin), kMarker, markerSize))) {
+            int i = std::atoi(found + markerSize);
+            if (i >= 0 && i < criticals_ && arrived_[i] == 0) {
+                arrived_[i] = arrival;
+            }
+            begin = found + markerSize;
+        }
+    }
+
+    int fd_;
+    std::unique_ptr<std::atomic<int64_t>[]> logged_;
+    std::unique_ptr<int64_t[]> arrived_; // Tailing thread only, until finish()
+    int criticals_;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+Result measure(const char* engine, bool lane, bool sync, int flooders, int criticals, const char* path) {
+    setenv("LOG_QUEUE_ENGINE", engine, 1);
+    setenv("LOG_PRIORITY_LEVEL", lane ? "critical" : "off", 1);
+    setenv("LOG_PRIORITY_SYNC", sync ? "on" : "off", 1);
+    auto& facade = LoggerFacade::getInstance();
+    facade.initialize();
+    auto logger = facade.getLogger();
+    FileArrivals arrivals(path, criticals);
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> flood;
+    for (int t = 0; t < flooders; ++t) {
+        flood.emplace_back([&logger, &stop, t]() {
+            for (long i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+                logger->debug("thread {} polled sensor {} with value {}", t, i % 64, i);
+            }
+        });
+    }
+    // Let the queue fill up before the first critical
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    for (int i = 0; i < criticals; ++i) {
+        arrivals.logged(i);
+        logger->critical("critical event {}", i);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    stop.store(true);
+    for (auto& thread : flood) {
+        thread.join();
+    }
+    logger.reset();
+    facade.shutdown();
+    Result result;
+    result.flushed = facade.priorityLatency();
+    arrivals.finish(result);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int flooders = argc > 1 ? std::atoi(argv[1]) : 4;
+    int criticals = argc > 2 ? std::atoi(argv[2]) : 200;
+    const char* path = argc > 3 ? argv[3] : "/tmp/logix-prioritybench.log";
+    if (flooders <= 0 || criticals <= 0) {
+        std::fprintf(stderr, "Usage: %s [flooding threads] [critical records] [log file]\n", argv[0]);
+        return 2;
+    }
+
+    Bench::logToFile(path, "debug");
+    std::FILE* out = Bench::redirectConsole();
+    if (!out) {
+        return 1;
+    }
+
+    std::fprintf(out, "%d threads logging debug, %d critical records, file %s\n", flooders, criticals, path);
+    std::fprintf(out, "%-8s %-5s %-5s %8s %12s %12s %8s %12s %12s\n", "engine", "lane", "sync", "flushed",
+                 "mean us", "max us", "in file", "mean us", "max us");
+    struct Mode {
+        bool lane;
+        bool sync;
+    };
+    for (const char* engine : {"spdlog", "mpsc", "spsc"}) {
+        // Lane off first: the baseline the lane is measured against
+        for (Mode mode : {Mode{false, false}, Mode{true, false}, Mode{true, true}}) {
+            std::remove(path);
+            Result result;
+            auto run = [&]() { return measure(engine, mode.lane, mode.sync, flooders, criticals, path); };
+            if (!Bench::inChild<Result>(run, result)) {
+                std::fprintf(stderr, "%s: run failed\n", engine);
+                return 1;
+            }
+            // Without the lane nothing records flush latency
+            char flushed[3][32] = {"-", "-", "-"};
+            if (mode.lane) {
+                std::snprintf(flushed[0], sizeof(flushed[0]), "%llu",
+                              static_cast<unsigned long long>(result.flushed.count));
+                std::snprintf(flushed[1], sizeof(flushed[1]), "%.1f", result.flushed.mean.count() / 1e3);
+                std::snprintf(flushed[2], sizeof(flushed[2]), "%.1f", result.flushed.max.count() / 1e3);
+            }
+            std::fprintf(out, "%-8s %-5s %-5s %8s %12s %12s %8llu %12.1f %12.1f\n", engine,
+                         mode.lane ? "on" : "off", mode.lane ? (mode.sync ? "on" : "off") : "-", flushed[0],
+                         flushed[1], flushed[2], static_cast<unsigned long long>(result.seen), result.seenMeanUs,
+                         result.seenMaxUs);
+            std::fflush(out);
+        }
+    }
+    std::remove(path);
+    return 0;
+}
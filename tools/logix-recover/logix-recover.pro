@@ -0,0 +1,16 @@
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= app_bundle qt
+
+DEFINES += SPDLOG_HEADER_ONLY
+
+INCLUDEPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../../spdlog/include
+
+SOURCES += \
+    main.cpp \
+    ../../jsonwriter.cpp
+
+HEADERS += \
+    ../../crashringformat.h \
+    ../../jsonwriter.h
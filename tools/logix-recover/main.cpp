@@ -0,0 +1,159 @@
+#include "crashringformat.h"
+#include "jsonwriter.h"
+#include <spdlog/common.h>
+#include <spdlog/fmt/fmt.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+// Extracts the records of a crash ring (LOG_CRASH_RING_PATH) in the order they
+// were logged, as text or JSON lines. Works on the ring of a crashed process as
+// well as on a live one, whose records still being written are left out.
+// Usage: logix-recover [--json] <ring file>
+
+using namespace Logging;
+using namespace Logging::CrashRingFormat;
+
+namespace {
+
+struct Found {
+    uint64_t position;
+    const RecordHeader* record;
+};
+
+std::string formatTime(int64_t timeNs) {
+    std::time_t seconds = static_cast<std::time_t>(timeNs / 1000000000);
+    std::tm tm{};
+    localtime_r(&seconds, &tm);
+    char prefix[32];
+    std::strftime(prefix, sizeof(prefix), "%Y-%m-%d %H:%M:%S", &tm);
+    return fmt::format("{}.{:06}", prefix, (timeNs % 1000000000) / 1000);
+}
+
+bool readFile(const char* path, std::vector<char>& data) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        std::fprintf(stderr, "%s: cannot open file\n", path);
+        return false;
+    }
+    char buffer[64 * 1024];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + read);
+    }
+    std::fclose(file);
+    return true;
+}
+
+// Every committed record among the last capacity bytes before head. Walks the
+// ring record by record; where a header does not check out (a record torn by
+// the crash, or one half overwritten), it steps ahead kAlign bytes at a time.
+std::vector<Found> scan(const char* ring, uint64_t capacity, uint64_t head) {
+    uint64_t oldest = head > capacity ? head - capacity : 0;
+    std::vector<Found> found;
+    uint64_t offset = 0;
+    while (offset + sizeof(RecordHeader) <= capacity) {
+        const auto* record = reinterpret_cast<const RecordHeader*>(ring + offset);
+        uint64_t end = record->end.load(std::memory_order_acquire);
+        uint64_t size = record->size;
+        bool valid = size >= sizeof(RecordHeader) && size % kAlign == 0 && offset + size <= capacity && end >= size
+                     && (end - size) % capacity == offset && end - size >= oldest && end <= head
+                     && (record->type == static_cast<uint8_t>(RecordType::Padding)
+                         || sizeof(RecordHeader) + record->nameSize + record->fileSize + record->payloadSize <= size);
+        if (!valid) {
+            offset += kAlign;
+            continue;
+        }
+        if (record->type == static_cast<uint8_t>(RecordType::Record)) {
+            found.push_back(Found{end - size, record});
+        }
+        offset += size;
+    }
+    std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.position < b.position; });
+    return found;
+}
+
+void print(const RecordHeader& record, bool json, spdlog::memory_buf_t& line) {
+    const char* text = reinterpret_cast<const char*>(&record) + sizeof(RecordHeader);
+    spdlog::string_view_t name(text, record.nameSize);
+    spdlog::string_view_t file(text + record.nameSize, record.fileSize);
+    spdlog::string_view_t message(text + record.nameSize + record.fileSize, record.payloadSize);
+    auto levelValue = std::min<int>(record.level, spdlog::level::off);
+    spdlog::string_view_t level = spdlog::level::to_string_view(static_cast<spdlog::level::level_enum>(levelValue));
+    std::string time = formatTime(record.timeNs);
+    if (json) {
+        line.clear();
+        JsonWriter writer(line);
+        writer.beginObject();
+        writer.field("time", time);
+        writer.field("logger", name);
+        writer.field("level", level);
+        writer.numberField("thread", record.threadId);
+        if (record.fileSize > 0) {
+            writer.field("file", file);
+            writer.numberField("line", static_cast<uint64_t>(record.line));
+        }
+        writer.field("message", message);
+        if (record.truncated) {
+            writer.boolField("truncated", true);
+        }
+        writer.endObject();
+        std::fwrite(line.data(), 1, line.size(), stdout);
+        std::fputc('\n', stdout);
+    } else {
+        fmt::print("{} [{}] [{}] [{}] {}{}\n", time, name, level, record.threadId, message,
+                   record.truncated ? " [truncated]" : "");
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool json = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            path = nullptr;
+            break;
+        }
+    }
+    if (!path) {
+        std::fprintf(stderr, "Usage: %s [--json] <ring file>\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<char> data;
+    if (!readFile(path, data)) {
+        return 1;
+    }
+    const auto* header = reinterpret_cast<const FileHeader*>(data.data());
+    if (data.size() < kDataOffset || std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) {
+        std::fprintf(stderr, "%s: not a Logix crash ring\n", path);
+        return 1;
+    }
+    if (header->version != kVersion || header->byteOrderMark != kByteOrderMark) {
+        std::fprintf(stderr, "%s: unsupported version or byte order\n", path);
+        return 1;
+    }
+    if (data.size() < kDataOffset + header->capacity) {
+        std::fprintf(stderr, "%s: ring is shorter than its header says\n", path);
+        return 1;
+    }
+
+    uint64_t head = header->head.load(std::memory_order_acquire);
+    std::vector<Found> found = scan(data.data() + kDataOffset, header->capacity, head);
+    spdlog::memory_buf_t line;
+    for (const Found& entry : found) {
+        print(*entry.record, json, line);
+    }
+    std::fprintf(stderr, "%s: %zu records of pid %llu, ring created %s\n", path, found.size(),
+                 static_cast<unsigned long long>(header->pid), formatTime(header->createdNs).c_str());
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "benchharness.h"
+#include "loggerfacade.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Measures how each queue engine scales with the number of logging threads, from
+// 1 to 64, then with the number of workers, from 1 to 8 under 16 threads: the
+// time a thread spends per log call, and records per second until shutdown() has
+// written the last one to the file. Every thread logs its share of
+// a fixed total, nothing is dropped. Each run is a fresh process, as the facade
+// does not start over after shutdown(). The console sink writes to /dev/null.
+// Usage: logix-scalebench [records in total] [log file]
+
+using namespace Logging;
+
+namespace {
+
+struct Result {
+    double callNanos; // Per log call, averaged over the threads
+    double perSecond; // Records written per second
+};
+
+Result measure(const char* engine, int threads, int workers, long total) {
+    setenv("LOG_QUEUE_ENGINE", engine, 1);
+    setenv("LOG_WORKERS", std::to_string(workers).c_str(), 1);
+    auto& facade = LoggerFacade::getInstance();
+    facade.initialize();
+    auto logger = facade.getLogger();
+
+    long records = total / threads;
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<int64_t> callNanos{0};
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; ++t) {
+        producers.emplace_back([&, t]() {
+            ready.fetch_add(1);
+            while (!go.load()) {
+            }
+            auto start = std::chrono::steady_clock::now();
+            for (long i = 0; i < records; ++i) {
+                logger->info("thread {} request {} served in {} us", t, i, i % 1000);
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            callNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        });
+    }
+    while (ready.load() < threads) {
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    logger.reset();
+    facade.shutdown();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    Result result;
+    result.callNanos = static_cast<double>(callNanos.load()) / static_cast<double>(threads * records);
+    result.perSecond = static_cast<double>(threads * records) / std::chrono::duration<double>(elapsed).count();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long total = argc > 1 ? std::atol(argv[1]) : 640000;
+    const char* path = argc > 2 ? argv[2] : "/tmp/logix-scalebench.log";
+    if (total < 64) {
+        std::fprintf(stderr, "Usage: %s [records in total, at least 64] [log file]\n", argv[0]);
+        return 2;
+    }
+
+    Bench::logToFile(path, "info");
+    setenv("LOG_OVERFLOW_BLOCK_LEVEL", "trace", 0); // Every record is written, none dropped
+    std::FILE* out = Bench::redirectConsole();
+    if (!out) {
+        return 1;
+    }
+
+    auto run = [&](const char* engine, int threads, int workers) {
+        std::remove(path);
+        Result result;
+        if (!Bench::inChild<Result>([&]() { return measure(engine, threads, workers, total); }, result)) {
+            std::fprintf(stderr, "%s with %d threads and %d workers: run failed\n", engine, threads, workers);
+            return false;
+        }
+        std::fprintf(out, "%-8s %7d %7d %12.1f %14.0f\n", engine, threads, workers, result.callNanos,
+                     result.perSecond);
+        std::fflush(out);
+        return true;
+    };
+
+    std::fprintf(out, "%ld records in total, file %s\n", total, path);
+    std::fprintf(out, "%-8s %7s %7s %12s %14s\n", "engine", "threads", "workers", "ns/call", "records/s");
+    for (const char* engine : {"spdlog", "mpsc", "spsc"}) {
+        for (int threads = 1; threads <= 64; threads *= 2) {
+            if (!run(engine, threads, 1)) {
+                return 1;
+            }
+        }
+    }
+    for (const char* engine : {"spdlog", "mpsc", "spsc"}) {
+        for (int workers = 2; workers <= 8; workers *= 2) {
+            if (!run(engine, 16, workers)) {
+                return 1;
+            }
+        }
+    }
+    std::remove(path);
+    return 0;
+}
@@ -0,0 +1,22 @@
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= app_bundle qt
+
+DEFINES += SPDLOG_HEADER_ONLY
+
+INCLUDEPATH += $$PWD/../..
+INCLUDEPATH += $$PWD/../../spdlog/include
+
+SOURCES += \
+    main.cpp \
+    ../../jsonwriter.cpp \
+    ../../timestampcache.cpp \
+    ../../udpsink.cpp \
+    ../../udptransport.cpp
+
+HEADERS += \
+    ../../formattedsink.h \
+    ../../jsonwriter.h \
+    ../../timestampcache.h \
+    ../../udpsink.h \
+    ../../udptransport.h
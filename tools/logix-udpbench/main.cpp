@@ -0,0 +1,137 @@
+#include "udpsink.h"
+#include <spdlog/details/log_msg.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Measures the UDP sink on the worker's side, one record per datagram against
+// records coalesced into MTU-sized datagrams sent with sendmmsg (LOG_UDP_BATCH),
+// for both formats. Records go to a receiver on the loopback interface, which
+// counts what arrives.
+// Usage: logix-udpbench [records]
+
+using namespace Logging;
+
+namespace {
+
+// Drains a loopback socket on its own thread, counting datagrams and bytes
+class Receiver {
+public:
+    Receiver() {
+        fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) {
+            throw std::runtime_error("cannot create receiving socket");
+        }
+        int bufferBytes = 8 * 1024 * 1024;
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &bufferBytes, sizeof(bufferBytes));
+        timeval timeout{0, 100000};
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        if (::bind(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || ::getsockname(fd_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            ::close(fd_);
+            throw std::runtime_error("cannot bind receiving socket");
+        }
+        port_ = ntohs(address.sin_port);
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    ~Receiver() {
+        stop_.store(true);
+        thread_.join();
+        ::close(fd_);
+    }
+
+    uint16_t port() const { return port_; }
+    uint64_t datagrams() const { return datagrams_.load(); }
+    uint64_t bytes() const { return bytes_.load(); }
+
+    void reset() {
+        datagrams_.store(0);
+        bytes_.store(0);
+    }
+
+private:
+    void run() {
+        char buffer[65536];
+        while (!stop_.load()) {
+            ssize_t received = ::recv(fd_, buffer, sizeof(buffer), 0);
+            if (received >= 0) {
+                datagrams_.fetch_add(1);
+                bytes_.fetch_add(static_cast<uint64_t>(received));
+            }
+        }
+    }
+
+    int fd_ = -1;
+    uint16_t port_ = 0;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> datagrams_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::thread thread_;
+};
+
+// Nanoseconds per record logged into a sink for the receiver's port
+double measure(Receiver& receiver, const char* format, bool batching, long records) {
+    std::atomic<bool> drained{false};
+    UdpBatchOptions batch;
+    batch.enabled = batching;
+    // The queue counts as busy until the last record, as under sustained load
+    batch.queueDrained = [&drained]() { return drained.load(std::memory_order_relaxed); };
+    UdpSink sink(std::make_unique<PosixUdpTransport>("127.0.0.1", receiver.port(), 4 * 1024 * 1024),
+                 "%Y-%m-%d %H:%M:%S.%e [%n] [%l] %v", format, TimestampFormat::Local, batch);
+    const char text[] = "request served in 1234 us, status 200, 5678 bytes";
+    spdlog::details::log_msg msg("udpbench", spdlog::level::info, text);
+
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < records; ++i) {
+        msg.time = spdlog::log_clock::now();
+        sink.log(msg);
+    }
+    drained.store(true);
+    sink.flush();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(records);
+}
+
+void report(Receiver& receiver, const char* format, bool batching, long records) {
+    receiver.reset();
+    double nanos = measure(receiver, format, batching, records);
+    // Give the receiver time to take what is still in its socket buffer
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    std::printf("%-6s %-11s %8.1f ns/record %10.0f records/s %9llu datagrams %8.1f MB received\n", format,
+                batching ? "batched" : "per-record", nanos, 1e9 / nanos,
+                static_cast<unsigned long long>(receiver.datagrams()), receiver.bytes() / 1e6);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long records = argc > 1 ? std::atol(argv[1]) : 1000000;
+    if (records <= 0) {
+        std::fprintf(stderr, "Usage: %s [records]\n", argv[0]);
+        return 2;
+    }
+
+    try {
+        Receiver receiver;
+        for (const char* format : {"json", "plain"}) {
+            report(receiver, format, false, records);
+            report(receiver, format, true, records);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
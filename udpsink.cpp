@@ -0,0 +1,151 @@
+#include "udpsink.h"
+#include "jsonwriter.h"
+#include <spdlog/pattern_formatter.h>
+#include <stdexcept>
+
+namespace Logging {
+
+UdpSink::UdpSink(std::unique_ptr<UdpTransport> transport, const std::string& pattern, const std::string& udp_format,
+                 TimestampFormat time_format, UdpBatchOptions batch)
+    : transport_(std::move(transport)), udp_format_(udp_format), timestamps_(time_format), batch_(std::move(batch)) {
+    if (!transport_) {
+        throw std::invalid_argument("Invalid UDP sink configuration: no transport");
+    }
+    if (batch_.enabled && batch_.mtu == 0) {
+        throw std::invalid_argument("Invalid UDP sink configuration: batch MTU must be positive");
+    }
+    // Set formatter with provided pattern
+    formatter_ = std::make_unique<spdlog::pattern_formatter>(pattern);
+}
+
+UdpSink::~UdpSink() {
+    // Deliver whatever is still pending, the queue will not drain again
+    std::lock_guard<std::mutex> lock(mutex_);
+    sendBatch();
+}
+
+void UdpSink::log(const spdlog::details::log_msg& msg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Format the message into a buffer reused across records
+    formatted_.clear();
+    formatter_->format(msg, formatted_);
+    send(msg, formatted_);
+}
+
+void UdpSink::logFormatted(const spdlog::details::log_msg& msg, const FormattedRecordPtr& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    send(msg, record->text);
+}
+
+void UdpSink::send(const spdlog::details::log_msg& msg, const spdlog::memory_buf_t& formatted) {
+    // Send as JSON or plain text based on udp_format_
+    const spdlog::memory_buf_t* payload = &formatted;
+    if (udp_format_ == "json") {
+        // Keys in the order nlohmann::json used to emit them
+        json_.clear();
+        JsonWriter writer(json_);
+        writer.beginObject();
+        writer.field("level", spdlog::level::to_string_view(msg.level));
+        writer.field("logger", msg.logger_name);
+        writer.field("message", spdlog::string_view_t(formatted.data(), formatted.size()));
+        if (timestamps_.format() == TimestampFormat::EpochNanos) {
+            writer.numberField("time", TimestampCache::epochNanos(msg.time));
+        } else {
+            writer.field("time", timestamps_.render(msg.time));
+        }
+        writer.endObject();
+        payload = &json_;
+    }
+
+    if (batch_.enabled) {
+        appendToBatch(payload->data(), payload->size(), msg.time);
+    } else {
+        transport_->send(payload->data(), payload->size());
+    }
+}
+
+void UdpSink::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // A flush request sitting in front of more records is served by the next drain
+    if (batch_.enabled && queueDrained()) {
+        sendBatch();
+    }
+}
+
+// A pending batch is due linger after its first record, even if no record follows
+spdlog::log_clock::time_point UdpSink::deadline() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!batch_.enabled || batchBuf_.size() == 0) {
+        return spdlog::log_clock::time_point::max();
+    }
+    return batchStarted_ + batch_.linger;
+}
+
+void UdpSink::expire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (batchBuf_.size() > 0 && spdlog::log_clock::now() - batchStarted_ >= batch_.linger) {
+        sendBatch();
+    }
+}
+
+void UdpSink::set_pattern(const std::string& pattern) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    formatter_ = std::make_unique<spdlog::pattern_formatter>(pattern);
+}
+
+void UdpSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    formatter_ = std::move(sink_formatter);
+}
+
+void UdpSink::closeDatagram() {
+    if (batchBuf_.size() > openDatagramStart()) {
+        datagramEnds_.push_back(batchBuf_.size());
+    }
+}
+
+// Append one newline-terminated record, sending the batch once it is due
+void UdpSink::appendToBatch(const char* data, size_t size, spdlog::log_clock::time_point time) {
+    bool needsNewline = size == 0 || data[size - 1] != '\n';
+    size_t recordSize = size + (needsNewline ? 1 : 0);
+
+    // Records never straddle datagrams, an oversized record travels alone
+    size_t openSize = batchBuf_.size() - openDatagramStart();
+    if (openSize > 0 && openSize + recordSize > batch_.mtu) {
+        closeDatagram();
+        if (datagramEnds_.size() >= kMaxBatchDatagrams) {
+            sendBatch();
+        }
+    }
+
+    if (batchBuf_.size() == 0) {
+        batchStarted_ = time;
+    }
+    batchBuf_.append(data, data + size);
+    if (needsNewline) {
+        batchBuf_.push_back('\n');
+    }
+
+    if (queueDrained() || time - batchStarted_ >= batch_.linger) {
+        sendBatch();
+    }
+}
+
+void UdpSink::sendBatch() {
+    closeDatagram();
+    if (datagramEnds_.empty()) {
+        return;
+    }
+    datagrams_.clear();
+    size_t start = 0;
+    for (size_t end : datagramEnds_) {
+        datagrams_.push_back(Datagram{batchBuf_.data() + start, end - start});
+        start = end;
+    }
+    transport_->sendBatch(datagrams_.data(), datagrams_.size());
+    batchBuf_.clear();
+    datagramEnds_.clear();
+}
+
+} // namespace Logging
@@ -0,0 +1,81 @@
+#pragma once
+#include "formattedsink.h"
+#include "timestampcache.h"
+#include "udptransport.h"
+#include <spdlog/formatter.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Logging {
+
+// Options for coalescing several records into one datagram
+struct UdpBatchOptions {
+    bool enabled = false;
+    size_t mtu = 1472; // Max payload per datagram (Ethernet MTU minus IP/UDP headers)
+    std::chrono::milliseconds linger{5}; // Max age of a batch; a sink queue's idle worker sends it then
+    std::function<bool()> queueDrained; // Reports whether the async queue has been emptied
+};
+
+// Custom UDP sink for network logging with JSON or plain text support. Both
+// formats carry the pattern-formatted line, so it can come from a FanoutSink.
+class UdpSink : public FormattedSink {
+public:
+    UdpSink(std::unique_ptr<UdpTransport> transport, const std::string& pattern, const std::string& udp_format,
+            TimestampFormat time_format = TimestampFormat::Local, UdpBatchOptions batch = {});
+    ~UdpSink() override;
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void logFormatted(const spdlog::details::log_msg& msg, const FormattedRecordPtr& record) override;
+    void flush() override;
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+    spdlog::log_clock::time_point deadline() override;
+    void expire() override;
+
+    void set_level(spdlog::level::level_enum level) {
+        level_ = level;
+    }
+
+    spdlog::level::level_enum level() const {
+        return level_;
+    }
+
+private:
+    // Upper bound of datagrams handed to the kernel in one batch
+    static constexpr size_t kMaxBatchDatagrams = 64;
+
+    bool queueDrained() const {
+        return !batch_.queueDrained || batch_.queueDrained();
+    }
+
+    size_t openDatagramStart() const {
+        return datagramEnds_.empty() ? 0 : datagramEnds_.back();
+    }
+
+    void send(const spdlog::details::log_msg& msg, const spdlog::memory_buf_t& formatted);
+    void closeDatagram();
+    void appendToBatch(const char* data, size_t size, spdlog::log_clock::time_point time);
+    void sendBatch();
+
+    std::unique_ptr<UdpTransport> transport_;
+    std::string udp_format_; // "json" or "plain"
+    spdlog::level::level_enum level_ = spdlog::level::trace;
+    std::unique_ptr<spdlog::formatter> formatter_;
+    spdlog::memory_buf_t formatted_; // Reused per record to avoid allocations
+    spdlog::memory_buf_t json_;
+    TimestampCache timestamps_; // "time" field of JSON records
+
+    // Guarded by mutex_ since flush() may come from other threads
+    std::mutex mutex_;
+    UdpBatchOptions batch_;
+    spdlog::memory_buf_t batchBuf_;     // Pending datagrams, back to back
+    std::vector<size_t> datagramEnds_;  // End offset of each closed datagram in batchBuf_
+    std::vector<Datagram> datagrams_;   // Views handed to the transport
+    spdlog::log_clock::time_point batchStarted_;
+};
+
+} // namespace Logging
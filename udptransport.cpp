@@ -0,0 +1,172 @@
+#include "udptransport.h"
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#ifdef LOGIX_WITH_QTNETWORK
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QString>
+#endif
+
+namespace Logging {
+
+void UdpTransport::sendBatch(const Datagram* datagrams, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        send(datagrams[i].data, datagrams[i].size);
+    }
+}
+
+PosixUdpTransport::PosixUdpTransport(const std::string& host, uint16_t port, size_t sendBufferBytes) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_NUMERICSERV;
+    addrinfo* result = nullptr;
+    std::string service = std::to_string(port);
+    int rc = ::getaddrinfo(host.c_str(), service.c_str(), &hints, &result);
+    if (rc != 0) {
+        throw std::runtime_error("Cannot resolve UDP host '" + host + "': " + ::gai_strerror(rc));
+    }
+
+    // Take the first address we can connect to
+    std::string lastError = "no usable address";
+    for (addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+        int fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            lastError = std::strerror(errno);
+            continue;
+        }
+        int flags = ::fcntl(fd, F_GETFL, 0);
+        if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0
+                || ::fcntl(fd, F_SETFD, FD_CLOEXEC) < 0 || ::connect(fd, ai->ai_addr, ai->ai_addrlen) < 0) {
+            lastError = std::strerror(errno);
+            ::close(fd);
+            continue;
+        }
+        fd_ = fd;
+        break;
+    }
+    ::freeaddrinfo(result);
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot open UDP socket to '" + host + "': " + lastError);
+    }
+
+    if (sendBufferBytes > 0) {
+        // The kernel caps this at net.core.wmem_max, a smaller buffer is not fatal
+        int size = static_cast<int>(sendBufferBytes);
+        ::setsockopt(fd_, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+    }
+}
+
+PosixUdpTransport::~PosixUdpTransport() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void PosixUdpTransport::send(const char* data, size_t size) {
+    // ECONNREFUSED reports an ICMP error caused by an earlier datagram; it is
+    // consumed by the failing call, so the current datagram gets one more try.
+    bool retried = false;
+    for (;;) {
+        ssize_t rc = ::send(fd_, data, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (rc >= 0) {
+            return;
+        }
+        if (errno == EINTR || (errno == ECONNREFUSED && !retried)) {
+            retried = retried || errno == ECONNREFUSED;
+            continue;
+        }
+        // EAGAIN means the socket buffer is full; never wait for it on the worker
+        countDropped(1);
+        return;
+    }
+}
+
+void PosixUdpTransport::sendBatch(const Datagram* datagrams, size_t count) {
+#ifdef __linux__
+    // Reused across calls on the same thread
+    thread_local std::vector<iovec> iovecs;
+    thread_local std::vector<mmsghdr> messages;
+    iovecs.resize(count);
+    messages.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        iovecs[i].iov_base = const_cast<char*>(datagrams[i].data);
+        iovecs[i].iov_len = datagrams[i].size;
+        std::memset(&messages[i], 0, sizeof(mmsghdr));
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    size_t sent = 0;
+    bool retried = false;
+    while (sent < count) {
+        int rc = ::sendmmsg(fd_, messages.data() + sent, static_cast<unsigned int>(count - sent), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (rc > 0) {
+            sent += static_cast<size_t>(rc);
+            continue;
+        }
+        if (rc < 0 && (errno == EINTR || (errno == ECONNREFUSED && !retried))) {
+            retried = retried || errno == ECONNREFUSED;
+            continue;
+        }
+        // Socket buffer full or a hard error: drop what is left of the batch
+        countDropped(count - sent);
+        return;
+    }
+#else
+    UdpTransport::sendBatch(datagrams, count);
+#endif
+}
+
+#ifdef LOGIX_WITH_QTNETWORK
+namespace {
+
+// QtNetwork backend, kept for platforms where the POSIX transport is unavailable
+class QtUdpTransport : public UdpTransport {
+public:
+    QtUdpTransport(const std::string& host, uint16_t port)
+        : address_(QString::fromStdString(host)), port_(port) {
+        if (address_.isNull()) {
+            throw std::runtime_error("Invalid UDP host address for Qt transport: " + host);
+        }
+    }
+
+    void send(const char* data, size_t size) override {
+        // Created in the worker thread on first use
+        if (!socket_) {
+            socket_ = std::make_unique<QUdpSocket>();
+        }
+        if (socket_->writeDatagram(data, static_cast<qint64>(size), address_, port_) < 0) {
+            countDropped(1);
+        }
+    }
+
+private:
+    QHostAddress address_;
+    uint16_t port_;
+    std::unique_ptr<QUdpSocket> socket_;
+};
+
+} // namespace
+#endif
+
+std::unique_ptr<UdpTransport> makeUdpTransport(const std::string& backend, const std::string& host,
+                                               uint16_t port, size_t sendBufferBytes) {
+    if (backend == "qt") {
+#ifdef LOGIX_WITH_QTNETWORK
+        return std::make_unique<QtUdpTransport>(host, port);
+#else
+        throw std::invalid_argument("UDP transport 'qt' requires building with CONFIG += logix_qtnetwork");
+#endif
+    }
+    return std::make_unique<PosixUdpTransport>(host, port, sendBufferBytes);
+}
+
+} // namespace Logging
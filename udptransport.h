@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Logging {
+
+// A datagram ready to be sent, pointing into the caller's buffer
+struct Datagram {
+    const char* data;
+    size_t size;
+};
+
+// Best-effort datagram delivery used by UdpSink. Implementations never block the
+// async worker: datagrams that cannot be handed to the kernel are counted and dropped.
+class UdpTransport {
+public:
+    virtual ~UdpTransport() = default;
+
+    virtual void send(const char* data, size_t size) = 0;
+
+    // Send several datagrams at once; the default sends them one by one
+    virtual void sendBatch(const Datagram* datagrams, size_t count);
+
+    // Datagrams dropped because the socket buffer was full or the send failed
+    size_t droppedDatagrams() const { return dropped_.load(std::memory_order_relaxed); }
+
+protected:
+    void countDropped(size_t count) { dropped_.fetch_add(count, std::memory_order_relaxed); }
+
+private:
+    std::atomic<size_t> dropped_{0};
+};
+
+// Native transport: the destination is resolved once and the non-blocking socket is
+// connect()ed to it, so sending is a single syscall without per-message parsing.
+class PosixUdpTransport : public UdpTransport {
+public:
+    // Throws std::runtime_error if the host cannot be resolved or the socket cannot be set up
+    PosixUdpTransport(const std::string& host, uint16_t port, size_t sendBufferBytes);
+    ~PosixUdpTransport() override;
+
+    PosixUdpTransport(const PosixUdpTransport&) = delete;
+    PosixUdpTransport& operator=(const PosixUdpTransport&) = delete;
+
+    void send(const char* data, size_t size) override;
+    void sendBatch(const Datagram* datagrams, size_t count) override;
+
+private:
+    int fd_ = -1;
+};
+
+// Create the transport for the given backend: "posix", or "qt" when built with QtNetwork
+std::unique_ptr<UdpTransport> makeUdpTransport(const std::string& backend, const std::string& host,
+                                               uint16_t port, size_t sendBufferBytes);
+
+} // namespace Logging